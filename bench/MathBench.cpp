@@ -0,0 +1,358 @@
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "maths/Mat4.hpp"
+#include "maths/Quat.hpp"
+#include "maths/Transform.hpp"
+#include "maths/Vec3.hpp"
+#include "maths/Vec3Array.hpp"
+
+// Throughput of the math types, run with `make bench-math`. Every operation
+// goes over batches of inputs small enough to stay in cache, is warmed up,
+// then timed over several samples of which the median is kept. Prints a
+// table and writes the same results as JSON, to bench_math.json or the path
+// given as the first argument, so that runs with other compilers or flags
+// can be compared. Operations working in place get their inputs restored
+// before every batch, outside of the timed region.
+
+namespace
+{
+	typedef std::chrono::steady_clock Clock;
+
+	const size_t batchSize = 1024;
+	const int sampleCount = 11;
+	const std::chrono::milliseconds warmupTime(100);
+	const std::chrono::milliseconds sampleTime(20);
+
+	struct Result
+	{
+		std::string name;
+		double nanosecondsPerOperation;
+		double operationsPerSecond;
+		size_t operations;
+	};
+
+	// Makes the compiler assume value is read, and any memory written, so
+	// neither the results nor the work producing them can be optimized out
+	template <typename T>
+	inline void keep(const T &value)
+	{
+		asm volatile("" : : "r"(&value) : "memory");
+	}
+
+	// Time spent in rounds runs of batch, prepare being run before each one
+	// without being timed
+	Clock::duration run(size_t rounds, const std::function<void()> &batch, const std::function<void()> &prepare)
+	{
+		if (!prepare)
+		{
+			const Clock::time_point start = Clock::now();
+			for (size_t i = 0; i < rounds; i++)
+				batch();
+			return Clock::now() - start;
+		}
+
+		Clock::duration elapsed(0);
+		for (size_t i = 0; i < rounds; i++)
+		{
+			prepare();
+			const Clock::time_point start = Clock::now();
+			batch();
+			elapsed += Clock::now() - start;
+		}
+		return elapsed;
+	}
+
+	// batch runs batchSize operations. Rounds per sample are doubled during
+	// the warmup until a sample lasts long enough for the clock.
+	Result measure(const std::string &name, const std::function<void()> &batch,
+				   const std::function<void()> &prepare = nullptr)
+	{
+		size_t rounds = 1;
+		const Clock::time_point warmupStart = Clock::now();
+
+		while (true)
+		{
+			const Clock::duration elapsed = run(rounds, batch, prepare);
+
+			if (elapsed >= sampleTime && Clock::now() - warmupStart >= warmupTime)
+				break;
+			if (elapsed < sampleTime)
+				rounds *= 2;
+		}
+
+		std::vector<double> samples;
+		for (int sample = 0; sample < sampleCount; sample++)
+		{
+			const std::chrono::duration<double, std::nano> elapsed = run(rounds, batch, prepare);
+			samples.push_back(elapsed.count() / (rounds * batchSize));
+		}
+
+		std::sort(samples.begin(), samples.end());
+		const double nanoseconds = samples[sampleCount / 2];
+		return {name, nanoseconds, 1e9 / nanoseconds, rounds * batchSize * sampleCount};
+	}
+
+	std::string simdLevel()
+	{
+#if defined(__AVX2__)
+		return "AVX2";
+#elif defined(__AVX__)
+		return "AVX";
+#elif defined(__SSE__)
+		return "SSE";
+#else
+		return "scalar";
+#endif
+	}
+
+	void printTable(const std::vector<Result> &results)
+	{
+		std::cout << std::left << std::setw(32) << "operation"
+				  << std::right << std::setw(12) << "ns/op" << std::setw(14) << "Mops/s" << std::endl;
+		std::cout << std::string(58, '-') << std::endl;
+
+		for (const Result &result : results)
+		{
+			std::cout << std::left << std::setw(32) << result.name << std::right << std::fixed
+					  << std::setw(12) << std::setprecision(3) << result.nanosecondsPerOperation
+					  << std::setw(14) << std::setprecision(1) << result.operationsPerSecond / 1e6 << std::endl;
+		}
+	}
+
+	void writeJson(const std::vector<Result> &results, const std::string &path)
+	{
+		std::ofstream file(path);
+		if (!file)
+		{
+			std::cerr << "Warning: could not write " << path << std::endl;
+			return;
+		}
+
+		file << "{\n";
+		file << "\t\"compiler\": \"" << __VERSION__ << "\",\n";
+		file << "\t\"simd\": \"" << simdLevel() << "\",\n";
+		file << "\t\"batch_size\": " << batchSize << ",\n";
+		file << "\t\"samples\": " << sampleCount << ",\n";
+		file << "\t\"results\": [\n";
+		for (size_t i = 0; i < results.size(); i++)
+		{
+			const Result &result = results[i];
+			file << "\t\t{\"name\": \"" << result.name << "\", "
+				 << std::setprecision(6) << "\"ns_per_op\": " << result.nanosecondsPerOperation << ", "
+				 << "\"ops_per_second\": " << std::fixed << std::setprecision(0) << result.operationsPerSecond << ", "
+				 << std::defaultfloat << "\"operations\": " << result.operations << "}"
+				 << (i + 1 < results.size() ? "," : "") << "\n";
+		}
+		file << "\t]\n}\n";
+
+		std::cout << std::endl << "Results written to " << path << std::endl;
+	}
+}
+
+int main(int argc, char **argv)
+{
+	const std::string jsonPath = argc > 1 ? argv[1] : "bench_math.json";
+
+	std::mt19937 random(42);
+	std::uniform_real_distribution<float> value(-10.0f, 10.0f);
+	std::uniform_real_distribution<float> angle(0.1f, 3.0f);
+
+	auto randomVec3 = [&]() { return Vec3(value(random), value(random), value(random)); };
+	auto randomMat4 = [&]()
+	{
+		float elements[4 * 4];
+		for (float &element : elements)
+			element = value(random);
+		return Mat4(elements);
+	};
+	auto randomQuat = [&]() { return Quat::axisAngle(angle(random), randomVec3().normalize()); };
+
+	std::vector<Mat4> matricesA(batchSize), matricesB(batchSize), matricesOut(batchSize);
+	std::vector<Mat3> normalsOut(batchSize);
+	std::vector<Vec3> vecsA(batchSize), vecsB(batchSize), vecsOut(batchSize);
+	std::vector<float> angles(batchSize), floatsOut(batchSize);
+	std::vector<Quat> quatsA(batchSize), quatsB(batchSize), quatsOut(batchSize);
+	std::vector<Transform> transformsA(batchSize), transformsB(batchSize), transformsOut(batchSize);
+
+	for (size_t i = 0; i < batchSize; i++)
+	{
+		matricesA[i] = randomMat4();
+		matricesB[i] = randomMat4();
+		vecsA[i] = randomVec3();
+		vecsB[i] = randomVec3();
+		angles[i] = angle(random);
+		quatsA[i] = randomQuat();
+		quatsB[i] = randomQuat();
+		transformsA[i] = Transform(randomVec3(), randomQuat(), angle(random));
+		transformsB[i] = Transform(randomVec3(), randomQuat(), angle(random));
+	}
+
+	Vec3Array arrayA(vecsA.data(), batchSize);
+	Vec3Array arrayOut(batchSize);
+	const Vec3 up(0.0f, 1.0f, 0.0f);
+
+	std::vector<Result> results;
+
+	results.push_back(measure("Mat4 * Mat4", [&]()
+	{
+		for (size_t i = 0; i < batchSize; i++)
+			matricesOut[i] = matricesA[i] * matricesB[i];
+		keep(matricesOut[0]);
+	}));
+
+	results.push_back(measure("Mat4::transformPoint", [&]()
+	{
+		for (size_t i = 0; i < batchSize; i++)
+			vecsOut[i] = matricesA[i].transformPoint(vecsA[i]);
+		keep(vecsOut[0]);
+	}));
+
+	results.push_back(measure("Mat4::transformPoints", [&]()
+	{
+		matricesA[0].transformPoints(vecsA.data(), vecsOut.data(), batchSize);
+		keep(vecsOut[0]);
+	}));
+
+	results.push_back(measure("Mat4::transpose", [&]()
+	{
+		for (size_t i = 0; i < batchSize; i++)
+			matricesOut[i] = matricesA[i].transpose();
+		keep(matricesOut[0]);
+	}));
+
+	results.push_back(measure("Mat4::inverse", [&]()
+	{
+		for (size_t i = 0; i < batchSize; i++)
+			matricesOut[i] = matricesA[i].inverse();
+		keep(matricesOut[0]);
+	}));
+
+	results.push_back(measure("Mat4::normalMatrix", [&]()
+	{
+		for (size_t i = 0; i < batchSize; i++)
+			normalsOut[i] = matricesA[i].normalMatrix();
+		keep(normalsOut[0]);
+	}));
+
+	results.push_back(measure("Mat4::lookAt", [&]()
+	{
+		for (size_t i = 0; i < batchSize; i++)
+			matricesOut[i] = Mat4::lookAt(vecsA[i], vecsB[i], up);
+		keep(matricesOut[0]);
+	}));
+
+	results.push_back(measure("Mat4::perspective", [&]()
+	{
+		for (size_t i = 0; i < batchSize; i++)
+			matricesOut[i] = Mat4::perspective(angles[i], 16.0f / 9.0f, 0.1f, 100.0f);
+		keep(matricesOut[0]);
+	}));
+
+	results.push_back(measure("Mat4::infinitePerspective", [&]()
+	{
+		for (size_t i = 0; i < batchSize; i++)
+			matricesOut[i] = Mat4::infinitePerspective(angles[i], 16.0f / 9.0f, 0.1f);
+		keep(matricesOut[0]);
+	}));
+
+	results.push_back(measure("Mat4::rotation", [&]()
+	{
+		for (size_t i = 0; i < batchSize; i++)
+			matricesOut[i] = Mat4::rotation(angles[i], up);
+		keep(matricesOut[0]);
+	}));
+
+	results.push_back(measure("Vec3::normalize", [&]()
+	{
+		for (size_t i = 0; i < batchSize; i++)
+			vecsOut[i] = vecsA[i].normalize();
+		keep(vecsOut[0]);
+	}));
+
+	results.push_back(measure("Vec3::dot", [&]()
+	{
+		for (size_t i = 0; i < batchSize; i++)
+			floatsOut[i] = vecsA[i].dot(vecsB[i]);
+		keep(floatsOut[0]);
+	}));
+
+	results.push_back(measure("Vec3::cross", [&]()
+	{
+		for (size_t i = 0; i < batchSize; i++)
+			vecsOut[i] = vecsA[i].cross(vecsB[i]);
+		keep(vecsOut[0]);
+	}));
+
+	const auto restoreArray = [&]()
+	{
+		arrayOut = arrayA;
+	};
+
+	results.push_back(measure("Vec3Array::transformPoints", [&]()
+	{
+		arrayOut.transformPoints(matricesA[0]);
+		keep(arrayOut.x[0]);
+	}, restoreArray));
+
+	results.push_back(measure("Vec3Array::normalize", [&]()
+	{
+		arrayOut.normalize();
+		keep(arrayOut.x[0]);
+	}, restoreArray));
+
+	results.push_back(measure("Vec3Array::dot", [&]()
+	{
+		arrayA.dot(up, floatsOut.data());
+		keep(floatsOut[0]);
+	}));
+
+	results.push_back(measure("Vec3Array::bounds", [&]()
+	{
+		Vec3 min(std::numeric_limits<float>::max()), max(std::numeric_limits<float>::lowest());
+		arrayA.bounds(min, max);
+		keep(min);
+		keep(max);
+	}));
+
+	results.push_back(measure("Quat * Quat", [&]()
+	{
+		for (size_t i = 0; i < batchSize; i++)
+			quatsOut[i] = quatsA[i] * quatsB[i];
+		keep(quatsOut[0]);
+	}));
+
+	results.push_back(measure("Quat::slerp", [&]()
+	{
+		for (size_t i = 0; i < batchSize; i++)
+			quatsOut[i] = Quat::slerp(quatsA[i], quatsB[i], 0.25f);
+		keep(quatsOut[0]);
+	}));
+
+	results.push_back(measure("Transform * Transform", [&]()
+	{
+		for (size_t i = 0; i < batchSize; i++)
+			transformsOut[i] = transformsA[i] * transformsB[i];
+		keep(transformsOut[0]);
+	}));
+
+	results.push_back(measure("Transform::toMat4", [&]()
+	{
+		for (size_t i = 0; i < batchSize; i++)
+			matricesOut[i] = transformsA[i].toMat4();
+		keep(matricesOut[0]);
+	}));
+
+	std::cout << "scop math benchmark, " << __VERSION__ << ", " << simdLevel() << std::endl << std::endl;
+	printTable(results);
+	writeJson(results, jsonPath);
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,63 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "engine/Mesh.hpp"
+#include "engine/Texture.hpp"
+
+enum class AssetType
+{
+	Mesh,
+	Texture
+};
+
+// Loads meshes and textures on a background thread, one request at a time.
+// Finished assets are collected with poll() and must then be uploaded on
+// the thread that owns the GL context. Each one posts an empty GLFW event,
+// so a loop blocked in glfwWaitEvents wakes up to collect it.
+class AssetLoader
+{
+	public:
+		struct Asset
+		{
+			AssetType type;
+			std::string path;
+			Mesh mesh;
+			Image image;
+			// Set instead of mesh/image when loading failed
+			std::string error;
+			// A chunk of a mesh still streaming in, to append to the previous ones
+			bool partial = false;
+		};
+
+	private:
+		struct Request
+		{
+			AssetType type;
+			std::string path;
+		};
+
+		std::mutex mutex;
+		std::condition_variable wakeUp;
+		std::deque<Request> requests;
+		std::deque<Asset> finished;
+		std::string currentPath;
+		std::atomic<float> currentProgress;
+		bool stopping;
+		std::thread worker;
+
+		void run();
+
+	public:
+		AssetLoader();
+		~AssetLoader();
+
+		void request(AssetType type, const std::string &path);
+		bool poll(Asset &asset);
+		// Whether an asset is queued or loading, with the path and progress of the current one
+		bool busy(std::string &path, float &progress);
+};
\ No newline at end of file
@@ -2,12 +2,21 @@
 #include <GLFW/glfw3.h>
 #include <cmath>
 
+#include "engine/CameraView.hpp"
 #include "maths/Vec3.hpp"
 #include "maths/Mat4.hpp"
 #include "maths/Utils.hpp"
 
 class Camera
 {
+	private:
+		CameraView view;
+		// What direction and the view were last computed from
+		float lastYaw, lastPitch;
+		Vec3 lastPosition, lastDirection, lastWorldUp;
+
+		void updateView();
+
 	public:
 		Vec3 position, direction, worldUp;
 		float yaw, pitch;
@@ -20,7 +29,14 @@ class Camera
 			Vec3 worldUp = Vec3(0.0f, 1.0f, 0.0f)
 		);
 
-		Mat4 getViewMatrix();
+		// The getters first catch up with changes to the fields above
+		const Mat4 &getViewMatrix();
+		const Mat4 &getViewProjection();
+		const Frustum &getFrustum();
+		unsigned long getVersion();
+		void setPerspective(float fov, float aspectRatio, float near);
+
+		// Recomputes direction, only when yaw or pitch changed
 		void updateCameraVectors();
 		void processKeyboardInput(GLFWwindow* window, float deltaTime);
 		void processMouseInput(float xOffset, float yOffset, bool constrainPitch = true);
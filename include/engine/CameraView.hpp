@@ -0,0 +1,33 @@
+#pragma once
+#include "engine/Frustum.hpp"
+#include "maths/Mat4.hpp"
+
+// What renderers need from a camera, kept from one frame to the next: the
+// view and projection matrices, their product and its frustum planes. They
+// are only rebuilt when the view or the projection parameters change, and
+// each change bumps the version, so that data derived from them only has to
+// be uploaded again when the version differs.
+class CameraView
+{
+	private:
+		Mat4 view, projection, viewProjection;
+		Frustum frustum;
+		float fov, aspectRatio, near;
+		unsigned long version;
+
+		void update();
+
+	public:
+		CameraView();
+
+		void setView(const Mat4 &view);
+		// Infinite perspective, see Mat4::infinitePerspective
+		void setPerspective(float fov, float aspectRatio, float near);
+
+		const Mat4 &getView() const;
+		const Mat4 &getProjection() const;
+		const Mat4 &getViewProjection() const;
+		// In world space
+		const Frustum &getFrustum() const;
+		unsigned long getVersion() const;
+};
\ No newline at end of file
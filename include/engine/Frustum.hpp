@@ -0,0 +1,25 @@
+#pragma once
+#include "maths/Mat4.hpp"
+#include "maths/Vec3.hpp"
+#include "maths/Vec3Array.hpp"
+#include <vector>
+
+// View volume of a model-view-projection matrix, in the space of the model
+class Frustum
+{
+	private:
+		// Left, right, bottom, top and near, facing inwards with unit normals
+		// so that distances come out in model units. There is no far plane,
+		// the projection is infinite.
+		Vec3 normals[5];
+		float distances[5];
+
+	public:
+		Frustum(const Mat4 &modelViewProjection);
+
+		bool containsSphere(const Vec3 &center, float radius) const;
+		bool containsBox(const Vec3 &min, const Vec3 &max) const;
+		// containsSphere over a batch of spheres of the same radius, one
+		// plane at a time: visible[i] is set for centers[i]
+		void containsSpheres(const Vec3Array &centers, float radius, std::vector<unsigned char> &visible) const;
+};
\ No newline at end of file
@@ -0,0 +1,31 @@
+#pragma once
+#include <string>
+#include <vector>
+
+#include "maths/Vec3.hpp"
+#include "engine/Texture.hpp"
+
+// Surface properties read from an MTL file, white and untextured by default
+struct Material
+{
+	std::string name;
+	Vec3 ambient, diffuse, specular;
+	float shininess;
+	float opacity;
+	// map_Kd, relative to the folder of the library it came from
+	std::string diffuseMap;
+
+	// The decoded diffuse map until Mesh::upload turns it into diffuseTexture
+	Image diffuseImage;
+	Texture diffuseTexture;
+	bool textured;
+
+	Material(const std::string &name = "");
+};
+
+// Parses the materials of an MTL file, throws if it can't be read
+std::vector<Material> parseMtl(const std::string &path);
+
+// Fills in the materials found in the libraries, matched by name, and decodes
+// their diffuse maps. Anything missing is reported and keeps the defaults.
+void loadMaterials(std::vector<Material> &materials, const std::vector<std::string> &libraries);
\ No newline at end of file
@@ -1,8 +1,13 @@
 #pragma once
+#include <atomic>
+#include <functional>
 #include <vector>
 
 #include "maths/Vec2.hpp"
 #include "maths/Vec3.hpp"
+#include "maths/Mat4.hpp"
+#include "maths/Transform.hpp"
+#include "engine/Material.hpp"
 #include "engine/Texture.hpp"
 
 struct Vertex
@@ -17,23 +22,139 @@ struct BoundingBox
 	Vec3 min, max;
 };
 
+// A part of the mesh, from an OBJ object or group, drawn with one material
+struct Submesh
+{
+	std::string name;
+	unsigned int material;
+	// Ranges of the full mesh's indices and of its meshlets
+	unsigned int firstIndex, indexCount;
+	unsigned int firstMeshlet, meshletCount;
+	BoundingBox boundingBox;
+};
+
+// A coarser index buffer over the same vertices as the full mesh
+struct MeshLod
+{
+	std::vector<unsigned int> indices;
+	// Where each submesh starts in indices, followed by the end of the last one
+	std::vector<unsigned int> submeshOffsets;
+	// RMS distance to the full mesh of the worst collapse behind this level, in mesh units
+	float error;
+};
+
+// A cluster of at most 64 vertices and 124 triangles, culled as a whole
+struct Meshlet
+{
+	// Range of the full mesh's indices
+	unsigned int firstIndex, indexCount;
+	// Bounding sphere
+	Vec3 center;
+	float radius;
+};
+
+// Layout of the vertices on the GPU, the CPU copy always stays full precision
+enum class VertexFormat
+{
+	Full,
+	// Quantized to 16 bytes, see PackedVertex
+	Packed
+};
+
+// Sets up the rendering state of a material before its submeshes are drawn
+using MaterialBinder = std::function<void(const Material &material)>;
+
 class Mesh
 {
 private:
 	unsigned int VAO, VBO, EBO;
+	// Sizes of the GPU buffers, in vertices and indices
+	size_t vertexCapacity, indexCapacity;
+	VertexFormat format;
+	// Per-instance model matrices, transposed for the vertex shader
+	unsigned int instanceVBO;
+	size_t instanceCapacity, instanceCount;
+	// Visible ranges of the last culled draw, kept to reuse their memory
+	std::vector<GLsizei> drawCounts;
+	std::vector<const void *> drawOffsets;
+
+	void release();
+	void bindInstances();
 
 public:
 	std::vector<Vertex> vertices;
 	std::vector<unsigned int> indices;
 
+	// Levels of detail, each with about half the triangles of the previous one
+	std::vector<MeshLod> lods;
+	// Clusters of the full detail level, in index order
+	std::vector<Meshlet> meshlets;
+
+	// Parts in index order, which is sorted by material
+	std::vector<Submesh> submeshes;
+	std::vector<Material> materials;
+	// Resolved paths of the MTL files the materials come from
+	std::vector<std::string> materialLibraries;
+
 	BoundingBox boundingBox;
 	Vec3 center;
 	float size;
 
+	// Turns the vertex shader's attribute position into the mesh's own,
+	// identity unless the mesh was uploaded as VertexFormat::Packed
+	Vec3 positionScale, positionOffset;
+
+	// Constructors only build the CPU side and can run on any thread,
+	// upload() must then be called where the GL context is current
 	Mesh();
 	Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices);
+	// Copies the given buffers (e.g. a mapped cache file) with precomputed bounds
+	Mesh(const Vertex *vertices, size_t vertexCount, const unsigned int *indices, size_t indexCount,
+		 const BoundingBox &boundingBox, const Vec3 &center, float size);
+	Mesh(Mesh &&mesh) noexcept;
+	Mesh &operator=(Mesh &&mesh) noexcept;
+	Mesh(const Mesh &) = delete;
+	Mesh &operator=(const Mesh &) = delete;
+	~Mesh();
+
+	// Build lods and meshlets from the full mesh, before it is uploaded
+	void generateLods();
+	void generateMeshlets();
+	// The coarsest level (0 being the full mesh) whose error stays under
+	// threshold pixels when the mesh is drawn with the given scale, its center
+	// distance away from the camera, pixelsPerUnit being the size in pixels of
+	// one unit seen at a distance of one
+	size_t selectLod(float scale, float distance, float pixelsPerUnit, float threshold = 1.0f) const;
 
-	void draw();
+	void upload();
+	// Uploads the mesh again if it already was
+	void setFormat(VertexFormat format);
+	// Appends a chunk to an uploaded (or empty) mesh, growing its GPU buffers
+	// as needed and widening the bounds. Used to show a mesh while it streams in,
+	// always in VertexFormat::Full since the bounds keep changing, and without lods,
+	// meshlets or submeshes.
+	void append(const Mesh &chunk);
+	void draw(size_t lod = 0);
+	// Same, but only draws the submeshes, and at the full level the meshlets,
+	// that can be seen, binding each material before its triangles are drawn
+	void draw(const Mat4 &modelViewProjection, size_t lod = 0, const MaterialBinder &bindMaterial = nullptr);
+
+	// Placements of the copies drawInstanced() draws, turned into the model
+	// matrices the vertex shader reads from attributes 3 to 6. Dropped whenever
+	// the mesh is uploaded again. Transforms only scale uniformly, so normals
+	// can go through the upper 3x3 of those matrices.
+	void setInstances(const std::vector<Transform> &transforms);
+	// Draws every instance in one call per material, without culling
+	void drawInstanced(size_t lod = 0, const MaterialBinder &bindMaterial = nullptr);
 };
 
-Mesh loadMesh(const std::string &path);
\ No newline at end of file
+// Called with consecutive chunks of triangles while a large OBJ is parsed
+using MeshPreview = std::function<void(Mesh &&chunk)>;
+
+// Loads an OBJ into a mesh that still has to be uploaded. When given, progress
+// is updated from 0 to 1 as the file is parsed, and large files are parsed in
+// pieces whose triangles are handed to preview before the final mesh is built.
+// Without withLods the mesh gets no levels of detail, which saves building
+// them for meshes only ever seen up close, and is then not written to the cache.
+Mesh loadMesh(const std::string &path, std::atomic<float> *progress = nullptr, const MeshPreview &preview = nullptr,
+			  bool withLods = true);
\ No newline at end of file
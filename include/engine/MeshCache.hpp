@@ -0,0 +1,21 @@
+#pragma once
+#include <string>
+
+#include "engine/Mesh.hpp"
+#include "utils/FileSystem.hpp"
+
+// Binary .scopmesh files holding a fully built mesh, written after the first
+// load of an OBJ so later launches skip parsing. A cache is only used while its
+// source still has the same size and modification time (or, failing the
+// latter, the same content hash).
+namespace MeshCache
+{
+
+	// Loads the cached build of an OBJ into mesh if a valid one exists
+	bool load(const std::string &objectPath, Mesh &mesh);
+
+	// Writes the cache next to the OBJ, or into the user cache directory when
+	// that location is not writable
+	void store(const std::string &objectPath, const FileSystem::MappedFile &source, const Mesh &mesh);
+
+}
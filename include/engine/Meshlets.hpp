@@ -0,0 +1,22 @@
+#pragma once
+#include <vector>
+
+#include "engine/Frustum.hpp"
+#include "engine/Mesh.hpp"
+
+const unsigned int meshletMaximumVertices = 64;
+const unsigned int meshletMaximumTriangles = 124;
+
+// Splits every submesh into consecutive meshlets, so each one is a range of the
+// index buffer as well, and records which meshlets each submesh got. Triangles
+// are taken in order, which keeps meshlets compact once the list has been
+// optimized for the vertex cache.
+std::vector<Meshlet> buildMeshlets(const std::vector<Vertex> &vertices, const std::vector<unsigned int> &indices,
+								   std::vector<Submesh> &submeshes);
+
+// Appends the meshlets that can be seen as index counts and byte offsets for
+// glMultiDrawElements. Meshlets outside the frustum are skipped, ranges that
+// follow each other are merged. There is no back-facing test, as faces are
+// drawn from both sides.
+void cullMeshlets(const Meshlet *meshlets, size_t count, const Frustum &frustum,
+				  std::vector<GLsizei> &counts, std::vector<const void *> &offsets);
\ No newline at end of file
@@ -0,0 +1,9 @@
+#pragma once
+#include "engine/ObjParser.hpp"
+
+// Fills data.normals with angle-weighted smooth normals and points every
+// corner at one of them. Faces meeting at an angle above creaseAngle (in
+// radians) keep separate normals along their shared edge; pass pi or more to
+// smooth everything. Around positions shared by many faces, smoothing follows
+// the edges between faces, so it can go around a crease reached from both sides.
+void generateNormals(ObjData &data, float creaseAngle);
\ No newline at end of file
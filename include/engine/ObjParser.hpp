@@ -0,0 +1,51 @@
+#pragma once
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "maths/Vec2.hpp"
+#include "maths/Vec3.hpp"
+
+// A face corner, as 0-based indices into the attribute arrays (-1 when absent)
+struct ObjCorner
+{
+	int position, uv, normal;
+};
+
+// An o, g or usemtl statement, which applies from firstCorner on
+struct ObjGroup
+{
+	size_t firstCorner;
+	// Objects and groups both name the part, usemtl sets its material instead
+	bool setsMaterial;
+	std::string value;
+};
+
+struct ObjData
+{
+	std::vector<Vec3> positions;
+	std::vector<Vec2> uvs;
+	std::vector<Vec3> normals;
+	// Faces are fan-triangulated, so every 3 corners form a triangle
+	std::vector<ObjCorner> corners;
+	std::vector<ObjGroup> groups;
+	// Paths of the mtllib statements, as written in the file
+	std::vector<std::string> materialLibraries;
+	// Whether a face used negative indices, which depend on what precedes the range
+	bool relativeIndices = false;
+};
+
+// Attribute counts declared before a parsed range
+struct ObjOffsets
+{
+	size_t positions = 0, uvs = 0, normals = 0;
+};
+
+// Parses a range of whole lines on the calling thread
+ObjData parseObjRange(const char *begin, const char *end, const ObjOffsets &offsets = ObjOffsets());
+
+// Parses a range of whole lines, split at line boundaries into chunks parsed in
+// parallel. The result is identical to parsing it with parseObjRange. When
+// given, progress receives the fraction of the range parsed so far.
+ObjData parseObj(const char *begin, const char *end, const ObjOffsets &offsets = ObjOffsets(),
+				 std::atomic<float> *progress = nullptr);
\ No newline at end of file
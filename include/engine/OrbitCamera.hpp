@@ -1,12 +1,19 @@
 #pragma once
 #include <GLFW/glfw3.h>
 
+#include "engine/CameraView.hpp"
 #include "maths/Vec3.hpp"
 #include "maths/Mat4.hpp"
 #include "maths/Utils.hpp"
 
 class OrbitCamera
 {
+	private:
+		CameraView view;
+		// What position and the view were last computed from
+		Vec3 lastTarget, lastWorldUp;
+		float lastDistance, lastPitch, lastYaw;
+
 	public:
 		Vec3 position;
 		Vec3 target;
@@ -22,9 +29,17 @@ class OrbitCamera
 			Vec3 worldUp = Vec3(0.0f, 1.0f, 0.0f)
 		);
 
-		Mat4 getViewMatrix();
+		// The getters first catch up with changes to the fields above
+		const Mat4 &getViewMatrix();
+		const Mat4 &getViewProjection();
+		const Frustum &getFrustum();
+		unsigned long getVersion();
+		void setPerspective(float fov, float aspectRatio, float near);
+
 		void processMouseInput(float xOffset, float yOffset);
 		void processKeyboardInput(GLFWwindow *window, float deltaTime);
 		void processMouseScroll(float yOffset);
+		// Recomputes position and the view, only when target, distance,
+		// pitch, yaw or worldUp changed since the last time
 		void updateCamera();
 };
\ No newline at end of file
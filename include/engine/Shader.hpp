@@ -1,26 +1,96 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
+#include <string_view>
+#include <vector>
 #include <glad/glad.h>
 
 #include "maths/Vec2.hpp"
 #include "maths/Vec3.hpp"
 #include "maths/Mat4.hpp"
 
+// A uniform of a linked program, resolved once through Shader::uniform() and
+// then set without any lookup. Setting an invalid handle does nothing.
+template <typename T>
+class UniformHandle
+{
+	private:
+		unsigned int program;
+		int location;
+
+	public:
+		UniformHandle() : program(0), location(-1) {}
+		UniformHandle(unsigned int program, int location) : program(program), location(location) {}
+
+		bool valid() const { return location >= 0; }
+		void set(const T &value) const;
+};
+
+template <> void UniformHandle<bool>::set(const bool &value) const;
+template <> void UniformHandle<int>::set(const int &value) const;
+template <> void UniformHandle<float>::set(const float &value) const;
+template <> void UniformHandle<Vec2>::set(const Vec2 &value) const;
+template <> void UniformHandle<Vec3>::set(const Vec3 &value) const;
+template <> void UniformHandle<Mat4>::set(const Mat4 &value) const;
+
 class Shader
 {
+	private:
+		// Default block uniforms of the program, enumerated once after linking
+		struct ActiveUniform
+		{
+			std::string name;
+			int location;
+			GLenum type;
+		};
+
+		std::vector<ActiveUniform> uniforms;
+
+		// Stages still being compiled, with the key to cache the result under
+		unsigned int vertexShader, fragmentShader;
+		uint64_t cacheKey;
+
+		// Submits the sources for compiling and linking into ID without
+		// waiting for the driver, finish() collects the result
+		void compile(const std::string &vertexSource, const std::string &fragmentSource);
+		void enumerateUniforms();
+		const ActiveUniform *findUniform(std::string_view name, GLenum type) const;
+
 	public:
 		unsigned int ID;
 
-		Shader(const std::string vertexFilePath, const std::string fragmentFilePath);
+		Shader();
+		// Each define is injected as "#define <define>" right after #version
+		Shader(const std::string vertexFilePath, const std::string fragmentFilePath,
+			   const std::vector<std::string> &defines = {});
+
+		// Same, but returns as soon as the driver has the sources. Building
+		// several programs before finishing any lets drivers with
+		// GL_KHR_parallel_shader_compile work on them at once.
+		static Shader start(const std::string &vertexFilePath, const std::string &fragmentFilePath,
+							const std::vector<std::string> &defines = {});
+		// Waits for the program started above, reporting errors
+		void finish();
 
 		void use();
 
-		// Uniforms
-		void setBool(const std::string name, const bool value) const;
-		void setInt(const std::string name, const int value) const;
-		void setFloat(const std::string name, const float value) const;
-		void setVec2(const std::string name, const Vec2& value) const;
-		void setVec3(const std::string name, const Vec3& value) const;
-		void setMat4(const std::string name, const Mat4& value) const;
-};
\ No newline at end of file
+		// Invalid when the program has no such uniform or it has another type
+		template <typename T>
+		UniformHandle<T> uniform(std::string_view name) const;
+
+		// Uniforms, looked up on each call: resolve a handle instead in the frame loop
+		void setBool(std::string_view name, const bool value) const;
+		void setInt(std::string_view name, const int value) const;
+		void setFloat(std::string_view name, const float value) const;
+		void setVec2(std::string_view name, const Vec2& value) const;
+		void setVec3(std::string_view name, const Vec3& value) const;
+		void setMat4(std::string_view name, const Mat4& value) const;
+};
+
+template <> UniformHandle<bool> Shader::uniform(std::string_view name) const;
+template <> UniformHandle<int> Shader::uniform(std::string_view name) const;
+template <> UniformHandle<float> Shader::uniform(std::string_view name) const;
+template <> UniformHandle<Vec2> Shader::uniform(std::string_view name) const;
+template <> UniformHandle<Vec3> Shader::uniform(std::string_view name) const;
+template <> UniformHandle<Mat4> Shader::uniform(std::string_view name) const;
\ No newline at end of file
@@ -0,0 +1,21 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+// Linked program binaries saved with glGetProgramBinary into the user cache
+// directory, so later launches skip compiling and linking. Binaries are keyed
+// by the sources and the driver's vendor, renderer and version strings, and
+// the driver may still reject one, in which case the program is rebuilt.
+namespace ShaderCache
+{
+
+	// Key of the sources on the driver of the current context
+	uint64_t key(const std::string &vertexSource, const std::string &fragmentSource);
+
+	// Loads the cached binary into program, true if it linked
+	bool load(unsigned int program, uint64_t key);
+
+	// Saves the binary of a linked program
+	void store(unsigned int program, uint64_t key);
+
+}
\ No newline at end of file
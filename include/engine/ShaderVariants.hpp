@@ -0,0 +1,36 @@
+#pragma once
+#include <map>
+#include <string>
+#include <vector>
+
+#include "engine/Shader.hpp"
+
+// Features a shader permutation is compiled with, each one a #define of the
+// same name in the sources
+enum ShaderFeature : unsigned int
+{
+	// Shows normals as colors instead of shading, ignores the other features
+	NormalView = 1 << 0,
+	// Samples objectTexture
+	Textured = 1 << 1,
+	// Ambient, diffuse and specular lighting
+	Lit = 1 << 2
+};
+
+// Programs built from one pair of sources with different sets of features,
+// each compiled once and kept for the lifetime of the set
+class ShaderVariants
+{
+	private:
+		std::string vertexFilePath, fragmentFilePath;
+		std::map<unsigned int, Shader> programs;
+
+	public:
+		ShaderVariants(const std::string &vertexFilePath, const std::string &fragmentFilePath);
+
+		// Builds all of these permutations up front, in parallel where the
+		// driver supports it
+		void prepare(const std::vector<unsigned int> &featureSets);
+		// The program for a set of ShaderFeature flags, built on first use
+		Shader &get(unsigned int features);
+};
\ No newline at end of file
@@ -0,0 +1,13 @@
+#pragma once
+#include <vector>
+
+#include "engine/Mesh.hpp"
+
+// Builds progressively coarser index buffers over the same vertices by
+// quadric error metric edge collapse (Garland and Heckbert, 1997). Vertices are
+// never moved, only merged into a neighbour, so every level can share the
+// vertex buffer of the full mesh. Each level has about half the triangles of
+// the one before, the chain stops once that no longer pays off. Triangles keep
+// their order, so every level has its own range for each submesh.
+std::vector<MeshLod> buildLodChain(const std::vector<Vertex> &vertices, const std::vector<unsigned int> &indices,
+								   const std::vector<Submesh> &submeshes);
\ No newline at end of file
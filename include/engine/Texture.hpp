@@ -2,9 +2,22 @@
 #include <iostream>
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
+#include <memory>
 #include <string>
 #include "stb_image.h"
 
+// Decoded pixels, which can be produced on any thread and uploaded later
+struct Image
+{
+	int width, height, channels;
+	std::unique_ptr<unsigned char, void (*)(void *)> pixels;
+
+	Image();
+};
+
+Image loadImage(const std::string &path);
+
+// Owns its GL texture, which is deleted with it, so it can only be moved
 class Texture
 {
 	private:
@@ -13,6 +26,11 @@ class Texture
 	public:
 		Texture();
 		Texture(const std::string& path);
+		Texture(const Image& image);
+		Texture(Texture &&texture) noexcept;
+		Texture &operator=(Texture &&texture) noexcept;
+		Texture(const Texture &) = delete;
+		Texture &operator=(const Texture &) = delete;
 		~Texture();
 
 		void bind(unsigned int slot = 0) const;
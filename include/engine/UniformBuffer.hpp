@@ -0,0 +1,97 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <glad/glad.h>
+
+#include "maths/Vec3.hpp"
+#include "maths/Mat3.hpp"
+#include "maths/Mat4.hpp"
+
+// Binding points of the uniform blocks declared in the shaders
+enum UniformBinding : unsigned int
+{
+	FrameBinding = 0,
+	ObjectBinding = 1,
+	MaterialBinding = 2
+};
+
+// A row_major mat3 as std140 lays it out, each row padded to a vec4
+struct Std140Mat3
+{
+	float rows[3][4];
+
+	Std140Mat3 &operator=(const Mat3 &mat)
+	{
+		for (unsigned int row = 0; row < 3; row++)
+		{
+			for (unsigned int column = 0; column < 3; column++)
+				rows[row][column] = mat(row, column);
+			rows[row][3] = 0.0f;
+		}
+		return *this;
+	}
+};
+
+// CPU copies of the std140 blocks. Matrices are declared row_major in the
+// shaders so Mat4 goes in as is, and a vec3 takes 16 bytes unless a scalar
+// follows it.
+struct FrameBlock
+{
+	Mat4 viewProjection;
+	Vec3 lightPosition;
+	float lightPadding;
+	Vec3 viewPosition;
+	float padding;
+};
+
+struct ObjectBlock
+{
+	Mat4 model;
+	Mat4 modelViewProjection;
+	// Inverse transpose of the model's upper 3x3
+	Std140Mat3 normalMatrix;
+	// Dequantizes packed positions, see Mesh::positionScale
+	Vec3 positionScale;
+	int32_t instanced;
+	Vec3 positionOffset;
+	float padding;
+};
+
+struct MaterialBlock
+{
+	Vec3 diffuse;
+	float padding;
+};
+
+static_assert(sizeof(Mat4) == 64 && sizeof(Vec3) == 12, "Uniform blocks expect tightly packed maths types");
+static_assert(offsetof(FrameBlock, viewPosition) == 80 && sizeof(FrameBlock) == 96, "FrameBlock must match std140");
+static_assert(offsetof(ObjectBlock, positionOffset) == 192 && sizeof(ObjectBlock) == 208, "ObjectBlock must match std140");
+static_assert(sizeof(MaterialBlock) == 16, "MaterialBlock must match std140");
+
+// A buffer bound to a fixed uniform block binding point, rewritten whole
+// with a single glBufferSubData on each update
+class UniformBuffer
+{
+	private:
+		unsigned int ID;
+		size_t size;
+
+		void release();
+
+	public:
+		UniformBuffer();
+		UniformBuffer(UniformBinding binding, size_t size);
+		UniformBuffer(UniformBuffer &&buffer) noexcept;
+		UniformBuffer &operator=(UniformBuffer &&buffer) noexcept;
+		UniformBuffer(const UniformBuffer &) = delete;
+		UniformBuffer &operator=(const UniformBuffer &) = delete;
+		~UniformBuffer();
+
+		void update(const void *data, size_t size);
+
+		template <typename Block>
+		void update(const Block &block)
+		{
+			update(&block, sizeof(Block));
+		}
+};
\ No newline at end of file
@@ -0,0 +1,29 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+struct VertexCacheStats
+{
+	// Average cache miss ratio: transformed vertices per triangle, 0.5 at best
+	float acmr;
+	// Average transform to vertex ratio: transformed vertices per vertex, 1 at best
+	float atvr;
+};
+
+// Size of the FIFO cache the optimizer targets and the statistics simulate
+const unsigned int vertexCacheSize = 16;
+
+// Simulates a FIFO post-transform cache over a triangle list
+VertexCacheStats analyzeVertexCache(const std::vector<unsigned int> &indices, size_t vertexCount);
+
+// Reorders the triangles of a list for post-transform cache locality, using
+// Tipsify (Sander, Nehab and Barczak, 2007). Runs in linear time.
+void optimizeVertexCache(std::vector<unsigned int> &indices, size_t vertexCount);
+// Same, within one range of a larger list, whose triangles stay in the range.
+// Vertices are renumbered locally, so the cost only depends on the range size.
+void optimizeVertexCache(unsigned int *indices, size_t indexCount);
+
+// Renumbers vertices in the order the triangles first use them so fetches walk
+// the vertex buffer forward. Rewrites indices and returns, for each new vertex,
+// the old one it comes from; unused vertices are dropped.
+std::vector<unsigned int> optimizeVertexFetch(std::vector<unsigned int> &indices, size_t vertexCount);
\ No newline at end of file
@@ -0,0 +1,26 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "engine/Mesh.hpp"
+
+// Compact layout for uploads, 16 bytes instead of the 32 of Vertex:
+// - position: 16-bit unsigned normalized, relative to the bounding box, the
+//   vertex shader scales it back with the positionScale/positionOffset uniforms
+// - texCoords: half floats
+// - normal: signed normalized 10_10_10_2 (GL_INT_2_10_10_10_REV)
+struct PackedVertex
+{
+	uint16_t position[3];
+	uint16_t padding;
+	uint16_t texCoords[2];
+	uint32_t normal;
+};
+
+uint16_t packHalf(float value);
+uint32_t packNormal(const Vec3 &normal);
+
+// Quantizes vertices against the box, which should contain all of them
+std::vector<PackedVertex> packVertices(const std::vector<Vertex> &vertices, const BoundingBox &boundingBox);
+// Size of the box along each axis, never 0 so it can always be divided by
+Vec3 quantizationScale(const BoundingBox &boundingBox);
\ No newline at end of file
@@ -0,0 +1,589 @@
+#pragma once
+#include <cstddef>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <type_traits>
+
+#include "maths/Utils.hpp"
+#include "maths/Vec.hpp"
+
+// Mat<4, float> products, sums, transposes and transforms go through SSE (and
+// AVX for products) kernels at runtime when the compiler targets them. They
+// give the same bits as the scalar code, which constant evaluation and every
+// other type use.
+#if defined(__SSE__)
+# define MATHS_SSE
+namespace maths::simd
+{
+	void add(const float *a, const float *b, float *result);
+	void subtract(const float *a, const float *b, float *result);
+	void multiply(const float *a, float scalar, float *result);
+	void multiply(const float *a, const float *b, float *result);
+	void transpose(const float *a, float *result);
+	void transform(const float *a, const Vec<3, float> *input, Vec<3, float> *output, size_t count, bool point);
+}
+#endif
+
+// Row-major square matrix, header-only and constexpr. Vectors are columns,
+// the 4x4 factories build transforms for them.
+template <size_t N, typename T>
+class Mat
+{
+
+	private:
+		alignas(N == 4 ? 16 : alignof(T)) T elements[N * N];
+
+		static constexpr bool simd = N == 4 && std::is_same_v<T, float>;
+
+	public:
+		constexpr Mat() : elements{} {}
+
+		constexpr Mat(const T diagonal) : elements{}
+		{
+			for (size_t i = 0; i < N; i++)
+				elements[i + i * N] = diagonal;
+		}
+
+		constexpr Mat(const T elements[N * N]) : elements{}
+		{
+			for (size_t i = 0; i < N * N; i++)
+				this->elements[i] = elements[i];
+		}
+
+		constexpr T& operator()(const unsigned int row, const unsigned int column)
+		{
+			return elements[column + row * N];
+		}
+
+		constexpr const T& operator()(const unsigned int row, const unsigned int column) const
+		{
+			return elements[column + row * N];
+		}
+
+		constexpr Mat operator+(const Mat& mat) const
+		{
+			Mat result;
+#ifdef MATHS_SSE
+			if constexpr (simd)
+			{
+				if (!maths::isConstantEvaluated())
+				{
+					maths::simd::add(elements, mat.elements, result.elements);
+					return result;
+				}
+			}
+#endif
+			for (size_t i = 0; i < N * N; i++)
+				result.elements[i] = elements[i] + mat.elements[i];
+			return result;
+		}
+
+		constexpr Mat operator-(const Mat& mat) const
+		{
+			Mat result;
+#ifdef MATHS_SSE
+			if constexpr (simd)
+			{
+				if (!maths::isConstantEvaluated())
+				{
+					maths::simd::subtract(elements, mat.elements, result.elements);
+					return result;
+				}
+			}
+#endif
+			for (size_t i = 0; i < N * N; i++)
+				result.elements[i] = elements[i] - mat.elements[i];
+			return result;
+		}
+
+		constexpr Mat operator*(const Mat& mat) const
+		{
+			Mat result;
+#ifdef MATHS_SSE
+			if constexpr (simd)
+			{
+				if (!maths::isConstantEvaluated())
+				{
+					maths::simd::multiply(elements, mat.elements, result.elements);
+					return result;
+				}
+			}
+#endif
+			for (size_t row = 0; row < N; row++)
+			{
+				for (size_t column = 0; column < N; column++)
+				{
+					T sum = T(0);
+					for (size_t i = 0; i < N; i++)
+						sum += elements[i + row * N] * mat.elements[column + i * N];
+					result.elements[column + row * N] = sum;
+				}
+			}
+			return result;
+		}
+
+		constexpr Mat operator*(const T scalar) const
+		{
+			Mat result;
+#ifdef MATHS_SSE
+			if constexpr (simd)
+			{
+				if (!maths::isConstantEvaluated())
+				{
+					maths::simd::multiply(elements, scalar, result.elements);
+					return result;
+				}
+			}
+#endif
+			for (size_t i = 0; i < N * N; i++)
+				result.elements[i] = elements[i] * scalar;
+			return result;
+		}
+
+		constexpr Vec<N, T> operator*(const Vec<N, T>& vec) const
+		{
+			Vec<N, T> result;
+			for (size_t row = 0; row < N; row++)
+			{
+				T sum = elements[row * N] * vec[0];
+				for (size_t i = 1; i < N; i++)
+					sum += elements[i + row * N] * vec[i];
+				result[row] = sum;
+			}
+			return result;
+		}
+
+		// Transforms a point, see transformPoint
+		constexpr Vec<N - 1, T> operator*(const Vec<N - 1, T>& vec) const
+		{
+			return transformPoint(vec);
+		}
+
+		constexpr Mat& operator+=(const Mat& mat) { return *this = *this + mat; }
+		constexpr Mat& operator-=(const Mat& mat) { return *this = *this - mat; }
+		constexpr Mat& operator*=(const Mat& mat) { return *this = *this * mat; }
+
+		constexpr bool operator==(const Mat& mat) const
+		{
+			for (size_t i = 0; i < N * N; i++)
+			{
+				if (elements[i] != mat.elements[i])
+					return false;
+			}
+			return true;
+		}
+
+		constexpr bool operator!=(const Mat& mat) const
+		{
+			return !(*this == mat);
+		}
+
+		constexpr const T* getElements() const
+		{
+			return elements;
+		}
+
+		constexpr Mat transpose() const
+		{
+			Mat result;
+#ifdef MATHS_SSE
+			if constexpr (simd)
+			{
+				if (!maths::isConstantEvaluated())
+				{
+					maths::simd::transpose(elements, result.elements);
+					return result;
+				}
+			}
+#endif
+			for (size_t row = 0; row < N; row++)
+			{
+				for (size_t column = 0; column < N; column++)
+					result.elements[row + column * N] = elements[column + row * N];
+			}
+			return result;
+		}
+
+		// Points get the translation, directions don't. Neither divides by w.
+		constexpr Vec<3, T> transformPoint(const Vec<3, T>& point) const
+		{
+			Vec<3, T> result;
+			transformPoints(&point, &result, 1);
+			return result;
+		}
+
+		constexpr Vec<3, T> transformDirection(const Vec<3, T>& direction) const
+		{
+			Vec<3, T> result;
+			transformDirections(&direction, &result, 1);
+			return result;
+		}
+
+		// Same over arrays, transposing the matrix once for the whole batch.
+		// output may be input.
+		constexpr void transformPoints(const Vec<3, T>* input, Vec<3, T>* output, size_t count) const
+		{
+			static_assert(N == 4, "Point transforms need a 4x4 matrix");
+#ifdef MATHS_SSE
+			if constexpr (simd)
+			{
+				if (!maths::isConstantEvaluated())
+					return maths::simd::transform(elements, input, output, count, true);
+			}
+#endif
+			for (size_t i = 0; i < count; i++)
+			{
+				const Vec<3, T> vec = input[i];
+				output[i] = Vec<3, T>(
+					elements[0 + 0 * 4] * vec.x + elements[1 + 0 * 4] * vec.y + elements[2 + 0 * 4] * vec.z + elements[3 + 0 * 4],
+					elements[0 + 1 * 4] * vec.x + elements[1 + 1 * 4] * vec.y + elements[2 + 1 * 4] * vec.z + elements[3 + 1 * 4],
+					elements[0 + 2 * 4] * vec.x + elements[1 + 2 * 4] * vec.y + elements[2 + 2 * 4] * vec.z + elements[3 + 2 * 4]
+				);
+			}
+		}
+
+		constexpr void transformDirections(const Vec<3, T>* input, Vec<3, T>* output, size_t count) const
+		{
+			static_assert(N == 4, "Direction transforms need a 4x4 matrix");
+#ifdef MATHS_SSE
+			if constexpr (simd)
+			{
+				if (!maths::isConstantEvaluated())
+					return maths::simd::transform(elements, input, output, count, false);
+			}
+#endif
+			for (size_t i = 0; i < count; i++)
+			{
+				const Vec<3, T> vec = input[i];
+				output[i] = Vec<3, T>(
+					elements[0 + 0 * 4] * vec.x + elements[1 + 0 * 4] * vec.y + elements[2 + 0 * 4] * vec.z,
+					elements[0 + 1 * 4] * vec.x + elements[1 + 1 * 4] * vec.y + elements[2 + 1 * 4] * vec.z,
+					elements[0 + 2 * 4] * vec.x + elements[1 + 2 * 4] * vec.y + elements[2 + 2 * 4] * vec.z
+				);
+			}
+		}
+
+		// Cofactor expansion through the 2x2 minors of the top and bottom row
+		// pairs, shared between the 16 cofactors. Singular matrices give the
+		// zero matrix. Affine matrices (last row 0 0 0 1) take the
+		// inverseAffine() path.
+		constexpr Mat inverse() const
+		{
+			static_assert(N == 4, "inverse is only implemented for 4x4 matrices");
+			const T *m = elements;
+
+			if (m[12] == T(0) && m[13] == T(0) && m[14] == T(0) && m[15] == T(1))
+				return inverseAffine();
+
+			const T s0 = m[0] * m[5] - m[1] * m[4];
+			const T s1 = m[0] * m[6] - m[2] * m[4];
+			const T s2 = m[0] * m[7] - m[3] * m[4];
+			const T s3 = m[1] * m[6] - m[2] * m[5];
+			const T s4 = m[1] * m[7] - m[3] * m[5];
+			const T s5 = m[2] * m[7] - m[3] * m[6];
+
+			const T c5 = m[10] * m[15] - m[11] * m[14];
+			const T c4 = m[9] * m[15] - m[11] * m[13];
+			const T c3 = m[9] * m[14] - m[10] * m[13];
+			const T c2 = m[8] * m[15] - m[11] * m[12];
+			const T c1 = m[8] * m[14] - m[10] * m[12];
+			const T c0 = m[8] * m[13] - m[9] * m[12];
+
+			const T determinant = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+			if (determinant == T(0))
+				return Mat();
+
+			const T d = T(1) / determinant;
+			Mat result;
+			T *r = result.elements;
+
+			r[0] = (m[5] * c5 - m[6] * c4 + m[7] * c3) * d;
+			r[1] = (-m[1] * c5 + m[2] * c4 - m[3] * c3) * d;
+			r[2] = (m[13] * s5 - m[14] * s4 + m[15] * s3) * d;
+			r[3] = (-m[9] * s5 + m[10] * s4 - m[11] * s3) * d;
+
+			r[4] = (-m[4] * c5 + m[6] * c2 - m[7] * c1) * d;
+			r[5] = (m[0] * c5 - m[2] * c2 + m[3] * c1) * d;
+			r[6] = (-m[12] * s5 + m[14] * s2 - m[15] * s1) * d;
+			r[7] = (m[8] * s5 - m[10] * s2 + m[11] * s1) * d;
+
+			r[8] = (m[4] * c4 - m[5] * c2 + m[7] * c0) * d;
+			r[9] = (-m[0] * c4 + m[1] * c2 - m[3] * c0) * d;
+			r[10] = (m[12] * s4 - m[13] * s2 + m[15] * s0) * d;
+			r[11] = (-m[8] * s4 + m[9] * s2 - m[11] * s0) * d;
+
+			r[12] = (-m[4] * c3 + m[5] * c1 - m[6] * c0) * d;
+			r[13] = (m[0] * c3 - m[1] * c1 + m[2] * c0) * d;
+			r[14] = (-m[12] * s3 + m[13] * s1 - m[14] * s0) * d;
+			r[15] = (m[8] * s3 - m[9] * s1 + m[10] * s0) * d;
+
+			return result;
+		}
+
+		// Only valid when the last row is 0 0 0 1: inverts the upper 3x3 and
+		// the translation on their own, much cheaper than the general case
+		// ┌       ┐-1   ┌                ┐
+		// │ A   t │     │ A^-1  -A^-1 t  │
+		// │ 0   1 │  =  │  0       1     │
+		// └       ┘     └                ┘
+		constexpr Mat inverseAffine() const
+		{
+			static_assert(N == 4, "inverseAffine is only implemented for 4x4 matrices");
+
+			// Transposed cofactors of A, A^-1 is them over the determinant. A
+			// singular A leaves them zero, and the whole inverse is zero too.
+			const Mat<3, T> cofactors = normalMatrix().transpose();
+			if (cofactors == Mat<3, T>())
+				return Mat();
+
+			Mat result(T(1));
+			for (unsigned int row = 0; row < 3; row++)
+			{
+				for (unsigned int column = 0; column < 3; column++)
+					result(row, column) = cofactors(row, column);
+			}
+
+			const Vec<3, T> translation = cofactors * Vec<3, T>((*this)(0, 3), (*this)(1, 3), (*this)(2, 3));
+			result(0, 3) = -translation.x;
+			result(1, 3) = -translation.y;
+			result(2, 3) = -translation.z;
+			return result;
+		}
+
+		// Inverse transpose of the upper 3x3, which transforms normals:
+		// the cofactor matrix over the determinant
+		constexpr Mat<3, T> normalMatrix() const
+		{
+			static_assert(N == 4, "normalMatrix is only implemented for 4x4 matrices");
+			const Mat &m = *this;
+			Mat<3, T> result;
+
+			result(0, 0) = m(1, 1) * m(2, 2) - m(1, 2) * m(2, 1);
+			result(0, 1) = m(1, 2) * m(2, 0) - m(1, 0) * m(2, 2);
+			result(0, 2) = m(1, 0) * m(2, 1) - m(1, 1) * m(2, 0);
+			result(1, 0) = m(0, 2) * m(2, 1) - m(0, 1) * m(2, 2);
+			result(1, 1) = m(0, 0) * m(2, 2) - m(0, 2) * m(2, 0);
+			result(1, 2) = m(0, 1) * m(2, 0) - m(0, 0) * m(2, 1);
+			result(2, 0) = m(0, 1) * m(1, 2) - m(0, 2) * m(1, 1);
+			result(2, 1) = m(0, 2) * m(1, 0) - m(0, 0) * m(1, 2);
+			result(2, 2) = m(0, 0) * m(1, 1) - m(0, 1) * m(1, 0);
+
+			const T determinant = m(0, 0) * result(0, 0) + m(0, 1) * result(0, 1) + m(0, 2) * result(0, 2);
+			if (determinant == T(0))
+				return Mat<3, T>();
+
+			const T d = T(1) / determinant;
+			for (unsigned int row = 0; row < 3; row++)
+			{
+				for (unsigned int column = 0; column < 3; column++)
+					result(row, column) *= d;
+			}
+			return result;
+		}
+
+		static constexpr Mat identity()
+		{
+			return Mat(T(1));
+		}
+
+		static constexpr Mat lookAt(const Vec<3, T>& position, const Vec<3, T>& target, const Vec<3, T>& worldUp)
+		{
+			// ┌                 ┐
+			// │  rx  ry  rz -tx │
+			// │  ux  uy  uz -ty │
+			// │ -fx -fy -fz  tz │
+			// │   0   0   0   1 │
+			// └                 ┘
+			static_assert(N == 4, "lookAt builds a 4x4 matrix");
+			Vec<3, T> forward = (target - position).normalize();
+			Vec<3, T> right = forward.cross(worldUp).normalize();
+			Vec<3, T> up = right.cross(forward).normalize();
+
+			Mat result(T(1));
+			result(0, 0) = right.x;
+			result(0, 1) = right.y;
+			result(0, 2) = right.z;
+			result(0, 3) = -right.dot(position);
+
+			result(1, 0) = up.x;
+			result(1, 1) = up.y;
+			result(1, 2) = up.z;
+			result(1, 3) = -up.dot(position);
+
+			result(2, 0) = -forward.x;
+			result(2, 1) = -forward.y;
+			result(2, 2) = -forward.z;
+			result(2, 3) = forward.dot(position);
+
+			result(3, 0) = T(0);
+			result(3, 1) = T(0);
+			result(3, 2) = T(0);
+			result(3, 3) = T(1);
+
+			return result;
+		}
+
+		static constexpr Mat orthographic(const T left, const T right, const T bottom, const T top, const T near, const T far)
+		{
+			static_assert(N == 4, "orthographic builds a 4x4 matrix");
+			Mat result(T(1));
+			result(0, 0) = T(2) / (right - left);
+			result(1, 1) = T(2) / (top - bottom);
+			result(2, 2) = T(2) / (near - far);
+			result(3, 0) = (left + right) / (left - right);
+			result(3, 1) = (bottom + top) / (bottom - top);
+			result(3, 2) = (far + near) / (far - near);
+			result(3, 3) = T(1);
+			return result;
+		}
+
+		static constexpr Mat perspective(const T fov, const T aspectRatio, const T near, const T far)
+		{
+			// ┌             ┐
+			// │  a  0  0  0 │
+			// │  0  q  0  0 │
+			// │  0  0  b  c │
+			// │  0  0 -1  0 │
+			// └             ┘
+			static_assert(N == 4, "perspective builds a 4x4 matrix");
+			Mat result(T(1));
+			T q = T(1) / maths::tan(T(0.5) * fov);
+			T a = q / aspectRatio;
+			T b = (near + far) / (near - far);
+			T c = (T(2) * near * far) / (near - far);
+			result(0, 0) = a;
+			result(1, 1) = q;
+			result(2, 2) = b;
+			result(2, 3) = c;
+			result(3, 2) = T(-1);
+			result(3, 3) = T(0);
+			return result;
+		}
+
+		static constexpr Mat infinitePerspective(const T fov, const T aspectRatio, const T near)
+		{
+			// ┌             ┐
+			// │  a  0  0  0 │
+			// │  0  q  0  0 │
+			// │  0  0 -1 -c │
+			// │  0  0 -1  0 │
+			// └             ┘
+			static_assert(N == 4, "infinitePerspective builds a 4x4 matrix");
+			Mat result(T(1));
+			T q = T(1) / maths::tan(T(0.5) * fov);
+			T a = q / aspectRatio;
+			T c = near;
+			result(0, 0) = a;
+			result(1, 1) = q;
+			result(2, 2) = T(-1);
+			result(2, 3) = -c;
+			result(3, 2) = T(-1);
+			result(3, 3) = T(0);
+			return result;
+		}
+
+		static constexpr Mat translation(const Vec<3, T>& translation)
+		{
+			// ┌             ┐
+			// │  1  0  0  x │
+			// │  0  1  0  y │
+			// │  0  0  1  z │
+			// │  0  0  0  1 │
+			// └             ┘
+			static_assert(N == 4, "translation builds a 4x4 matrix");
+			Mat result(T(1));
+			result(0, 3) = translation.x;
+			result(1, 3) = translation.y;
+			result(2, 3) = translation.z;
+			return result;
+		}
+
+		// https://en.wikipedia.org/wiki/Rotation_matrix#Rotation_matrix_from_axis_and_angle
+		static constexpr Mat rotation(const T rad, const Vec<3, T>& axis)
+		{
+			static_assert(N == 4, "rotation builds a 4x4 matrix");
+			Mat result(T(1));
+			T c = maths::cos(rad);
+			T ic = T(1) - c;
+			T s = maths::sin(rad);
+			T x = axis.x;
+			T y = axis.y;
+			T z = axis.z;
+
+			result(0, 0) = c + x * x * ic;
+			result(1, 0) = y * x * ic + z * s;
+			result(2, 0) = z * x * ic - y * s;
+
+			result(0, 1) = x * y * ic - z * s;
+			result(1, 1) = c + y * y * ic;
+			result(2, 1) = z * y * ic + x * s;
+
+			result(0, 2) = x * z * ic + y * s;
+			result(1, 2) = y * z * ic - x * s;
+			result(2, 2) = c + z * z * ic;
+
+			return result;
+		}
+
+		static constexpr Mat scale(const Vec<3, T>& scale)
+		{
+			// ┌             ┐
+			// │  x  0  0  0 │
+			// │  0  y  0  0 │
+			// │  0  0  z  0 │
+			// │  0  0  0  1 │
+			// └             ┘
+			static_assert(N == 4, "scale builds a 4x4 matrix");
+			Mat result(T(1));
+			result(0, 0) = scale.x;
+			result(1, 1) = scale.y;
+			result(2, 2) = scale.z;
+			return result;
+		}
+
+		friend std::ostream& operator<<(std::ostream& os, const Mat& mat)
+		{
+			unsigned int largestWidth = 0;
+
+			for (size_t i = 0; i < N * N; i++)
+			{
+				std::stringstream ss;
+				ss << std::fixed << std::setprecision(2) << mat.elements[i];
+				if (ss.str().length() > largestWidth)
+					largestWidth = ss.str().length();
+			}
+
+			os << "┌ ";
+			for (size_t i = 0; i < N; i++)
+				os << std::string(largestWidth + 1, ' ');
+			os << "┐" << std::endl;
+
+			for (size_t row = 0; row < N; row++)
+			{
+				os << "│ ";
+				for (size_t column = 0; column < N; column++)
+				{
+					std::stringstream ss;
+					ss << std::fixed << std::setprecision(2) << mat.elements[column + row * N];
+					std::string element = ss.str();
+					os << std::string(largestWidth - element.length(), ' ') << element;
+					if (column != N - 1)
+						os << " ";
+				}
+				os << " │" << std::endl;
+			}
+
+			os << "└ ";
+			for (size_t i = 0; i < N; i++)
+				os << std::string(largestWidth + 1, ' ');
+			os << "┘";
+
+			return os;
+		}
+
+};
+
+using Mat3 = Mat<3, float>;
+using Mat4 = Mat<4, float>;
\ No newline at end of file
@@ -0,0 +1,2 @@
+#pragma once
+#include "maths/Mat.hpp"
\ No newline at end of file
@@ -0,0 +1,130 @@
+#pragma once
+#include <cmath>
+#include <ostream>
+
+#include "maths/Mat4.hpp"
+#include "maths/Utils.hpp"
+#include "maths/Vec3.hpp"
+
+// Rotation quaternion, x y z the vector part and w the scalar part. Rotations
+// compose like the matrices they stand for: (a * b) * v is a * (b * v).
+class Quat
+{
+	public:
+		float x, y, z, w;
+
+		constexpr Quat() : x(0.0f), y(0.0f), z(0.0f), w(1.0f) {}
+		constexpr Quat(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
+
+		constexpr Quat operator*(const Quat& quat) const
+		{
+			return Quat(
+				w * quat.x + x * quat.w + y * quat.z - z * quat.y,
+				w * quat.y - x * quat.z + y * quat.w + z * quat.x,
+				w * quat.z + x * quat.y - y * quat.x + z * quat.w,
+				w * quat.w - x * quat.x - y * quat.y - z * quat.z);
+		}
+
+		// v + 2w (q x v) + 2 q x (q x v), for unit quaternions
+		constexpr Vec3 operator*(const Vec3& vec) const
+		{
+			const Vec3 axis(x, y, z);
+			const Vec3 t = axis.cross(vec) * 2.0f;
+			return vec + t * w + axis.cross(t);
+		}
+
+		constexpr bool operator==(const Quat& quat) const
+		{
+			return x == quat.x && y == quat.y && z == quat.z && w == quat.w;
+		}
+
+		constexpr bool operator!=(const Quat& quat) const
+		{
+			return !(*this == quat);
+		}
+
+		constexpr float dot(const Quat& quat) const
+		{
+			return x * quat.x + y * quat.y + z * quat.z + w * quat.w;
+		}
+
+		constexpr float magnitude() const
+		{
+			return maths::sqrt(dot(*this));
+		}
+
+		constexpr Quat normalize() const
+		{
+			const float length = magnitude();
+			return Quat(x / length, y / length, z / length, w / length);
+		}
+
+		// The inverse of a unit quaternion
+		constexpr Quat conjugate() const
+		{
+			return Quat(-x, -y, -z, w);
+		}
+
+		constexpr Mat4 toMat4() const
+		{
+			return toMat4(1.0f, Vec3(0.0f));
+		}
+
+		// The rotation matrix scaled by scale, with translation in its last
+		// column, written out at once
+		constexpr Mat4 toMat4(float scale, const Vec3& translation) const
+		{
+			const float xx = x * x, yy = y * y, zz = z * z;
+			const float xy = x * y, xz = x * z, yz = y * z;
+			const float wx = w * x, wy = w * y, wz = w * z;
+			const float s = 2.0f * scale;
+
+			const float elements[4 * 4] = {
+				scale - s * (yy + zz), s * (xy - wz), s * (xz + wy), translation.x,
+				s * (xy + wz), scale - s * (xx + zz), s * (yz - wx), translation.y,
+				s * (xz - wy), s * (yz + wx), scale - s * (xx + yy), translation.z,
+				0.0f, 0.0f, 0.0f, 1.0f
+			};
+			return Mat4(elements);
+		}
+
+		// Same rotation as Mat4::rotation(rad, axis), axis being a unit vector
+		static constexpr Quat axisAngle(float rad, const Vec3& axis)
+		{
+			const float s = maths::sin(0.5f * rad);
+			return Quat(axis.x * s, axis.y * s, axis.z * s, maths::cos(0.5f * rad));
+		}
+
+		// Constant angular speed from a to b as t goes from 0 to 1, along the
+		// shorter way round. Nearly equal rotations are interpolated linearly.
+		static Quat slerp(const Quat& a, const Quat& b, float t)
+		{
+			Quat to = b;
+			float cosine = a.dot(b);
+			if (cosine < 0.0f)
+			{
+				to = Quat(-b.x, -b.y, -b.z, -b.w);
+				cosine = -cosine;
+			}
+
+			float from = 1.0f - t, towards = t;
+			if (cosine < 0.9995f)
+			{
+				const float angle = std::acos(cosine);
+				const float s = std::sin(angle);
+				from = std::sin(from * angle) / s;
+				towards = std::sin(towards * angle) / s;
+			}
+
+			return Quat(
+				a.x * from + to.x * towards,
+				a.y * from + to.y * towards,
+				a.z * from + to.z * towards,
+				a.w * from + to.w * towards).normalize();
+		}
+
+		friend std::ostream& operator<<(std::ostream& os, const Quat& quat)
+		{
+			return os << "Quat(" << quat.x << ", " << quat.y << ", " << quat.z << ", " << quat.w << ")";
+		}
+};
\ No newline at end of file
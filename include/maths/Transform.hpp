@@ -0,0 +1,54 @@
+#pragma once
+#include <ostream>
+
+#include "maths/Mat4.hpp"
+#include "maths/Quat.hpp"
+#include "maths/Vec3.hpp"
+
+// Scale, then rotation, then translation: what translation(t) * rotation *
+// scale(s) does as a matrix, in half the memory. With a uniform scale two
+// transforms compose into another one, without any 4x4 product.
+class Transform
+{
+	public:
+		Vec3 translation;
+		Quat rotation;
+		float scale;
+
+		constexpr Transform() : translation(0.0f), rotation(), scale(1.0f) {}
+		constexpr Transform(const Vec3& translation, const Quat& rotation = Quat(), float scale = 1.0f)
+			: translation(translation), rotation(rotation), scale(scale) {}
+
+		// The transform applying transform first, then this one
+		constexpr Transform operator*(const Transform& transform) const
+		{
+			return Transform(transformPoint(transform.translation), rotation * transform.rotation, scale * transform.scale);
+		}
+
+		constexpr Vec3 transformPoint(const Vec3& point) const
+		{
+			return translation + rotation * (point * scale);
+		}
+
+		constexpr Vec3 transformDirection(const Vec3& direction) const
+		{
+			return rotation * (direction * scale);
+		}
+
+		constexpr Transform inverse() const
+		{
+			const Quat inverseRotation = rotation.conjugate();
+			const float inverseScale = 1.0f / scale;
+			return Transform(inverseRotation * translation * -inverseScale, inverseRotation, inverseScale);
+		}
+
+		constexpr Mat4 toMat4() const
+		{
+			return rotation.toMat4(scale, translation);
+		}
+
+		friend std::ostream& operator<<(std::ostream& os, const Transform& transform)
+		{
+			return os << "Transform(" << transform.translation << ", " << transform.rotation << ", " << transform.scale << ")";
+		}
+};
\ No newline at end of file
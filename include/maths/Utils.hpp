@@ -1,9 +1,119 @@
 #pragma once
 #include <cmath>
+#include <type_traits>
 
 namespace maths
 {
-	float radians(float degrees);
-	float degrees(float radians);
-	float clamp(float value, float min, float max);
+	// Whether the call is being evaluated at compile time, so constexpr
+	// functions can use exact library or SIMD code at runtime. Compilers
+	// that can't tell always take the runtime path: nothing changes at
+	// runtime, only constant expressions using the functions won't build.
+	constexpr bool isConstantEvaluated()
+	{
+#if defined(__cpp_lib_is_constant_evaluated)
+		return std::is_constant_evaluated();
+#elif defined(__clang__) && defined(__has_builtin)
+# if __has_builtin(__builtin_is_constant_evaluated)
+		return __builtin_is_constant_evaluated();
+# else
+		return false;
+# endif
+#elif defined(__GNUC__) && __GNUC__ >= 9
+		return __builtin_is_constant_evaluated();
+#else
+		return false;
+#endif
+	}
+
+	constexpr float radians(float degrees)
+	{
+		return degrees * M_PI / 180.0f;
+	}
+
+	constexpr float degrees(float radians)
+	{
+		return radians * 180.0f / M_PI;
+	}
+
+	constexpr float clamp(float value, float min, float max)
+	{
+		if (value < min)
+			return min;
+		if (value > max)
+			return max;
+		return value;
+	}
+
+	// The functions below call the standard library at runtime. At compile
+	// time they converge in double precision, which can differ from it in
+	// the last bit of a float.
+
+	template <typename T>
+	constexpr T sqrt(T value)
+	{
+		if (!isConstantEvaluated())
+			return std::sqrt(value);
+
+		// Zero, infinity and NaN are their own roots
+		if (value < 0)
+			return T(NAN);
+		if (value == 0 || value != value || value == value * 2)
+			return value;
+
+		double estimate = value < 1 ? 1.0 : (double)value;
+		for (int i = 0; i < 256; i++)
+		{
+			const double next = 0.5 * (estimate + value / estimate);
+			if (next == estimate)
+				break;
+			estimate = next;
+		}
+		return T(estimate);
+	}
+
+	namespace detail
+	{
+		// Taylor series of sin and cos on [-pi, pi]
+		constexpr double sinCos(double angle, bool cosine)
+		{
+			const double twoPi = 2.0 * M_PI;
+			while (angle > M_PI)
+				angle -= twoPi;
+			while (angle < -M_PI)
+				angle += twoPi;
+
+			double term = cosine ? 1.0 : angle;
+			double sum = term;
+			for (int n = cosine ? 1 : 2; n < 40; n += 2)
+			{
+				term *= -angle * angle / (n * (n + 1));
+				sum += term;
+			}
+			return sum;
+		}
+	}
+
+	template <typename T>
+	constexpr T sin(T angle)
+	{
+		if (!isConstantEvaluated())
+			return std::sin(angle);
+		return T(detail::sinCos(angle, false));
+	}
+
+	template <typename T>
+	constexpr T cos(T angle)
+	{
+		if (!isConstantEvaluated())
+			return std::cos(angle);
+		return T(detail::sinCos(angle, true));
+	}
+
+	template <typename T>
+	constexpr T tan(T angle)
+	{
+		if (!isConstantEvaluated())
+			return std::tan(angle);
+		return T(detail::sinCos(angle, false) / detail::sinCos(angle, true));
+	}
 }
\ No newline at end of file
@@ -0,0 +1,180 @@
+#pragma once
+#include <cstddef>
+#include <ostream>
+#include <utility>
+
+#include "maths/Utils.hpp"
+
+// Named components of the vectors, tightly packed so arrays of them can be
+// uploaded or written to disk as is
+template <size_t N, typename T>
+struct VecStorage;
+
+template <typename T>
+struct VecStorage<2, T>
+{
+	T x, y;
+
+	constexpr T &operator[](size_t i) { return i == 0 ? x : y; }
+	constexpr const T &operator[](size_t i) const { return i == 0 ? x : y; }
+};
+
+template <typename T>
+struct VecStorage<3, T>
+{
+	T x, y, z;
+
+	constexpr T &operator[](size_t i) { return i == 0 ? x : i == 1 ? y : z; }
+	constexpr const T &operator[](size_t i) const { return i == 0 ? x : i == 1 ? y : z; }
+};
+
+template <typename T>
+struct VecStorage<4, T>
+{
+	T x, y, z, w;
+
+	constexpr T &operator[](size_t i) { return i == 0 ? x : i == 1 ? y : i == 2 ? z : w; }
+	constexpr const T &operator[](size_t i) const { return i == 0 ? x : i == 1 ? y : i == 2 ? z : w; }
+};
+
+// Component-wise vector, header-only so every operation inlines into its
+// caller. Loops over N fold away once inlined, sums run from the first
+// component to the last like the hand-written expressions did.
+template <size_t N, typename T>
+class Vec : public VecStorage<N, T>
+{
+	private:
+		template <size_t... I>
+		constexpr Vec(T scalar, std::index_sequence<I...>) : VecStorage<N, T>{((void)I, scalar)...} {}
+
+	public:
+		constexpr Vec() : Vec(T(0)) {}
+		constexpr Vec(T scalar) : Vec(scalar, std::make_index_sequence<N>()) {}
+
+		template <typename... Components, typename = std::enable_if_t<sizeof...(Components) == N && (N > 1)>>
+		constexpr Vec(Components... components) : VecStorage<N, T>{T(components)...} {}
+
+		constexpr Vec operator+(const T scalar) const
+		{
+			Vec result;
+			for (size_t i = 0; i < N; i++)
+				result[i] = (*this)[i] + scalar;
+			return result;
+		}
+
+		constexpr Vec operator-(const T scalar) const
+		{
+			Vec result;
+			for (size_t i = 0; i < N; i++)
+				result[i] = (*this)[i] - scalar;
+			return result;
+		}
+
+		constexpr Vec operator*(const T scalar) const
+		{
+			Vec result;
+			for (size_t i = 0; i < N; i++)
+				result[i] = (*this)[i] * scalar;
+			return result;
+		}
+
+		constexpr Vec operator/(const T scalar) const
+		{
+			Vec result;
+			for (size_t i = 0; i < N; i++)
+				result[i] = (*this)[i] / scalar;
+			return result;
+		}
+
+		constexpr Vec operator+(const Vec& vec) const
+		{
+			Vec result;
+			for (size_t i = 0; i < N; i++)
+				result[i] = (*this)[i] + vec[i];
+			return result;
+		}
+
+		constexpr Vec operator-(const Vec& vec) const
+		{
+			Vec result;
+			for (size_t i = 0; i < N; i++)
+				result[i] = (*this)[i] - vec[i];
+			return result;
+		}
+
+		constexpr Vec operator*(const Vec& vec) const
+		{
+			Vec result;
+			for (size_t i = 0; i < N; i++)
+				result[i] = (*this)[i] * vec[i];
+			return result;
+		}
+
+		constexpr Vec& operator+=(const T scalar) { return *this = *this + scalar; }
+		constexpr Vec& operator-=(const T scalar) { return *this = *this - scalar; }
+		constexpr Vec& operator*=(const T scalar) { return *this = *this * scalar; }
+		constexpr Vec& operator/=(const T scalar) { return *this = *this / scalar; }
+
+		constexpr Vec& operator+=(const Vec& vec) { return *this = *this + vec; }
+		constexpr Vec& operator-=(const Vec& vec) { return *this = *this - vec; }
+		constexpr Vec& operator*=(const Vec& vec) { return *this = *this * vec; }
+
+		constexpr bool operator==(const Vec& vec) const
+		{
+			for (size_t i = 0; i < N; i++)
+			{
+				if ((*this)[i] != vec[i])
+					return false;
+			}
+			return true;
+		}
+
+		constexpr bool operator!=(const Vec& vec) const
+		{
+			return !(*this == vec);
+		}
+
+		constexpr T dot(const Vec& vec) const
+		{
+			T sum = (*this)[0] * vec[0];
+			for (size_t i = 1; i < N; i++)
+				sum += (*this)[i] * vec[i];
+			return sum;
+		}
+
+		constexpr T magnitude() const
+		{
+			return maths::sqrt(dot(*this));
+		}
+
+		constexpr Vec normalize() const
+		{
+			return *this / magnitude();
+		}
+
+		// The z of the 3D cross product for 2D vectors
+		constexpr auto cross(const Vec& vec) const
+		{
+			static_assert(N == 2 || N == 3, "cross is only defined in 2D and 3D");
+
+			if constexpr (N == 2)
+				return this->x * vec.y - this->y * vec.x;
+			else
+				return Vec(
+					this->y * vec.z - this->z * vec.y,
+					this->z * vec.x - this->x * vec.z,
+					this->x * vec.y - this->y * vec.x);
+		}
+
+		friend std::ostream& operator<<(std::ostream& os, const Vec& vec)
+		{
+			os << "Vec" << N << "(";
+			for (size_t i = 0; i < N; i++)
+				os << (i ? ", " : "") << vec[i];
+			return os << ")";
+		}
+};
+
+using Vec2 = Vec<2, float>;
+using Vec3 = Vec<3, float>;
+using Vec4 = Vec<4, float>;
\ No newline at end of file
@@ -0,0 +1,47 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+#include "maths/Mat4.hpp"
+#include "maths/Vec3.hpp"
+
+// Vec3s stored as a structure of arrays, one array per component, so that the
+// batch operations below fill whole SIMD registers: 8 vectors at a time with
+// AVX, 4 with SSE. Every element comes out with the same bits as the Vec3 or
+// Mat4 operation on it alone.
+class Vec3Array
+{
+	public:
+		std::vector<float> x, y, z;
+
+		Vec3Array();
+		Vec3Array(size_t count);
+		// stride is in bytes, so that one member of an array of structs can be
+		// picked out, e.g. the positions of vertices
+		Vec3Array(const Vec3 *vecs, size_t count, size_t stride = sizeof(Vec3));
+
+		// Same as the constructor, reusing the storage already allocated
+		void assign(const Vec3 *vecs, size_t count, size_t stride = sizeof(Vec3));
+
+		size_t size() const;
+		void resize(size_t count);
+		void append(const Vec3 &vec);
+
+		Vec3 operator[](size_t i) const;
+		void set(size_t i, const Vec3 &vec);
+
+		// In place, see Mat4::transformPoint and Mat4::transformDirection
+		void transformPoints(const Mat4 &matrix);
+		void transformDirections(const Mat4 &matrix);
+		void normalize();
+
+		// result holds size() floats
+		void dot(const Vec3 &vec, float *result) const;
+		void dot(const Vec3Array &array, float *result) const;
+		Vec3Array cross(const Vec3Array &array) const;
+
+		// Grows the box [min, max] to hold every element. Start with min at the
+		// largest float and max at the lowest for the bounds of the array
+		// alone; NaN components are skipped.
+		void bounds(Vec3 &min, Vec3 &max) const;
+};
\ No newline at end of file
@@ -1,10 +1,36 @@
 #pragma once
 #include <string>
 #include <fstream>
+#include <cstddef>
 
 namespace FileSystem
 {
 
 	std::string read(const std::string path);
 
-}
\ No newline at end of file
+	// Per-user cache directory ($XDG_CACHE_HOME/scop or ~/.cache/scop), created
+	// on first use. Empty when no usable location exists.
+	std::string cacheDirectory();
+
+	// Read-only memory mapping of a whole file, unmapped on destruction
+	class MappedFile
+	{
+		private:
+			const char *data;
+			size_t length;
+
+		public:
+			MappedFile();
+			MappedFile(const std::string &path);
+			MappedFile(MappedFile &&other) noexcept;
+			MappedFile &operator=(MappedFile &&other) noexcept;
+			MappedFile(const MappedFile &) = delete;
+			MappedFile &operator=(const MappedFile &) = delete;
+			~MappedFile();
+
+			const char *begin() const;
+			const char *end() const;
+			size_t size() const;
+	};
+
+}
@@ -0,0 +1,11 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace Hash
+{
+
+	// Fast non-cryptographic 64-bit hash (XXH64 layout), used to key on-disk caches
+	uint64_t bytes(const void *data, size_t size, uint64_t seed = 0);
+
+}
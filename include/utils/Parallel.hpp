@@ -0,0 +1,15 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+
+namespace Parallel
+{
+
+	unsigned int threadCount();
+
+	// Splits [0, count) into contiguous slices of at least minimumSlice items and
+	// runs function(begin, end) on each of them, one slice per hardware thread.
+	// The calling thread takes the first slice; exceptions are rethrown here.
+	void forRange(size_t count, size_t minimumSlice, const std::function<void(size_t, size_t)> &function);
+
+}
@@ -0,0 +1,106 @@
+#include "engine/AssetLoader.hpp"
+#include <stdexcept>
+
+AssetLoader::AssetLoader() : currentProgress(0.0f), stopping(false), worker(&AssetLoader::run, this) {}
+
+AssetLoader::~AssetLoader()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wakeUp.notify_one();
+	worker.join();
+}
+
+void AssetLoader::request(AssetType type, const std::string &path)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		requests.push_back({type, path});
+	}
+	wakeUp.notify_one();
+}
+
+bool AssetLoader::poll(Asset &asset)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if (finished.empty())
+		return false;
+
+	asset = std::move(finished.front());
+	finished.pop_front();
+	return true;
+}
+
+bool AssetLoader::busy(std::string &path, float &progress)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if (currentPath.empty() && requests.empty())
+		return false;
+
+	path = currentPath.empty() ? requests.front().path : currentPath;
+	progress = currentPath.empty() ? 0.0f : currentProgress.load();
+	return true;
+}
+
+void AssetLoader::run()
+{
+	while (true)
+	{
+		Request request;
+
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wakeUp.wait(lock, [this] { return stopping || !requests.empty(); });
+
+			if (stopping)
+				return;
+
+			request = requests.front();
+			requests.pop_front();
+			currentPath = request.path;
+			currentProgress = 0.0f;
+		}
+
+		Asset asset;
+		asset.type = request.type;
+		asset.path = request.path;
+
+		try
+		{
+			if (request.type == AssetType::Mesh)
+			{
+				asset.mesh = loadMesh(request.path, &currentProgress, [&](Mesh &&chunk)
+				{
+					Asset part;
+					part.type = AssetType::Mesh;
+					part.path = request.path;
+					part.mesh = std::move(chunk);
+					part.partial = true;
+
+					{
+						std::lock_guard<std::mutex> lock(mutex);
+						finished.push_back(std::move(part));
+					}
+					glfwPostEmptyEvent();
+				});
+			}
+			else
+				asset.image = loadImage(request.path);
+		}
+		catch (const std::exception &e)
+		{
+			asset.error = e.what();
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			finished.push_back(std::move(asset));
+			currentPath.clear();
+		}
+		glfwPostEmptyEvent();
+	}
+}
\ No newline at end of file
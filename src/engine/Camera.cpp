@@ -1,4 +1,5 @@
 #include "engine/Camera.hpp"
+#include <limits>
 
 Camera::Camera(
 	Vec3 position,
@@ -6,6 +7,11 @@ Camera::Camera(
 	float pitch,
 	Vec3 worldUp
 ):
+	lastYaw(std::numeric_limits<float>::quiet_NaN()),
+	lastPitch(std::numeric_limits<float>::quiet_NaN()),
+	lastPosition(std::numeric_limits<float>::quiet_NaN()),
+	lastDirection(std::numeric_limits<float>::quiet_NaN()),
+	lastWorldUp(std::numeric_limits<float>::quiet_NaN()),
 	position(position),
 	worldUp(worldUp),
 	yaw(yaw),
@@ -17,9 +23,45 @@ Camera::Camera(
 	updateCameraVectors();
 }
 
-Mat4 Camera::getViewMatrix()
+const Mat4 &Camera::getViewMatrix()
 {
-	return Mat4::lookAt(position, position + direction, worldUp);
+	updateView();
+	return view.getView();
+}
+
+const Mat4 &Camera::getViewProjection()
+{
+	updateView();
+	return view.getViewProjection();
+}
+
+const Frustum &Camera::getFrustum()
+{
+	updateView();
+	return view.getFrustum();
+}
+
+unsigned long Camera::getVersion()
+{
+	updateView();
+	return view.getVersion();
+}
+
+void Camera::setPerspective(float fov, float aspectRatio, float near)
+{
+	view.setPerspective(fov, aspectRatio, near);
+}
+
+void Camera::updateView()
+{
+	updateCameraVectors();
+	if (position == lastPosition && direction == lastDirection && worldUp == lastWorldUp)
+		return;
+
+	lastPosition = position;
+	lastDirection = direction;
+	lastWorldUp = worldUp;
+	view.setView(Mat4::lookAt(position, position + direction, worldUp));
 }
 
 void Camera::processKeyboardInput(GLFWwindow* window, float deltaTime)
@@ -67,6 +109,12 @@ void Camera::processMouseInput(float xOffset, float yOffset, bool constrainPitch
 
 void Camera::updateCameraVectors()
 {
+	if (yaw == lastYaw && pitch == lastPitch)
+		return;
+
+	lastYaw = yaw;
+	lastPitch = pitch;
+
 	Vec3 forward;
 	forward.x = std::cos(maths::radians(yaw)) * std::cos(maths::radians(pitch));
 	forward.y = std::sin(maths::radians(pitch));
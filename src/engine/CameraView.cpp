@@ -0,0 +1,57 @@
+#include "engine/CameraView.hpp"
+
+CameraView::CameraView() : view(1.0f), projection(1.0f), viewProjection(1.0f), frustum(viewProjection),
+						   fov(0.0f), aspectRatio(0.0f), near(0.0f), version(0) {}
+
+void CameraView::update()
+{
+	viewProjection = projection * view;
+	frustum = Frustum(viewProjection);
+	version++;
+}
+
+void CameraView::setView(const Mat4 &view)
+{
+	if (view == this->view)
+		return;
+
+	this->view = view;
+	update();
+}
+
+void CameraView::setPerspective(float fov, float aspectRatio, float near)
+{
+	if (fov == this->fov && aspectRatio == this->aspectRatio && near == this->near)
+		return;
+
+	this->fov = fov;
+	this->aspectRatio = aspectRatio;
+	this->near = near;
+	projection = Mat4::infinitePerspective(fov, aspectRatio, near);
+	update();
+}
+
+const Mat4 &CameraView::getView() const
+{
+	return view;
+}
+
+const Mat4 &CameraView::getProjection() const
+{
+	return projection;
+}
+
+const Mat4 &CameraView::getViewProjection() const
+{
+	return viewProjection;
+}
+
+const Frustum &CameraView::getFrustum() const
+{
+	return frustum;
+}
+
+unsigned long CameraView::getVersion() const
+{
+	return version;
+}
\ No newline at end of file
@@ -0,0 +1,70 @@
+#include "engine/Frustum.hpp"
+
+namespace
+{
+	Vec3 rowOf(const Mat4 &matrix, unsigned int row)
+	{
+		return Vec3(matrix(row, 0), matrix(row, 1), matrix(row, 2));
+	}
+}
+
+// Gribb and Hartmann: each plane is the w row plus or minus the x, y or z row
+Frustum::Frustum(const Mat4 &modelViewProjection)
+{
+	const unsigned int rows[5] = {0, 0, 1, 1, 2};
+	const float signs[5] = {1.0f, -1.0f, 1.0f, -1.0f, 1.0f};
+
+	for (int i = 0; i < 5; i++)
+	{
+		normals[i] = rowOf(modelViewProjection, 3) + rowOf(modelViewProjection, rows[i]) * signs[i];
+		distances[i] = modelViewProjection(3, 3) + modelViewProjection(rows[i], 3) * signs[i];
+
+		const float length = normals[i].magnitude();
+		if (length > 0.0f)
+		{
+			normals[i] /= length;
+			distances[i] /= length;
+		}
+	}
+}
+
+bool Frustum::containsSphere(const Vec3 &center, float radius) const
+{
+	for (int i = 0; i < 5; i++)
+	{
+		if (normals[i].dot(center) + distances[i] < -radius)
+			return false;
+	}
+	return true;
+}
+
+void Frustum::containsSpheres(const Vec3Array &centers, float radius, std::vector<unsigned char> &visible) const
+{
+	std::vector<float> along(centers.size());
+	visible.assign(centers.size(), 1);
+
+	for (int i = 0; i < 5; i++)
+	{
+		centers.dot(normals[i], along.data());
+		for (size_t j = 0; j < centers.size(); j++)
+		{
+			if (along[j] + distances[i] < -radius)
+				visible[j] = 0;
+		}
+	}
+}
+
+// Only the corner furthest along each normal has to be tested
+bool Frustum::containsBox(const Vec3 &min, const Vec3 &max) const
+{
+	for (int i = 0; i < 5; i++)
+	{
+		const Vec3 corner(normals[i].x >= 0.0f ? max.x : min.x,
+						  normals[i].y >= 0.0f ? max.y : min.y,
+						  normals[i].z >= 0.0f ? max.z : min.z);
+
+		if (normals[i].dot(corner) + distances[i] < 0.0f)
+			return false;
+	}
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,123 @@
+#include "engine/Material.hpp"
+#include "utils/FileSystem.hpp"
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+Material::Material(const std::string &name) : name(name), ambient(0.0f), diffuse(1.0f), specular(0.0f),
+											   shininess(0.0f), opacity(1.0f), textured(false)
+{
+}
+
+namespace
+{
+	std::string directoryOf(const std::string &path)
+	{
+		const size_t slash = path.find_last_of('/');
+		return slash == std::string::npos ? "" : path.substr(0, slash + 1);
+	}
+
+	Vec3 parseColor(std::istringstream &stream)
+	{
+		Vec3 color;
+		stream >> color.x >> color.y >> color.z;
+		return color;
+	}
+}
+
+std::vector<Material> parseMtl(const std::string &path)
+{
+	std::istringstream file(FileSystem::read(path));
+	std::vector<Material> materials;
+	std::string line;
+
+	while (std::getline(file, line))
+	{
+		std::istringstream stream(line);
+		std::string keyword;
+		stream >> keyword;
+
+		if (keyword == "newmtl")
+		{
+			std::string name;
+			std::getline(stream >> std::ws, name);
+			if (!name.empty() && name.back() == '\r')
+				name.pop_back();
+			materials.push_back(Material(name));
+		}
+		else if (materials.empty())
+			continue;
+		else if (keyword == "Ka")
+			materials.back().ambient = parseColor(stream);
+		else if (keyword == "Kd")
+			materials.back().diffuse = parseColor(stream);
+		else if (keyword == "Ks")
+			materials.back().specular = parseColor(stream);
+		else if (keyword == "Ns")
+			stream >> materials.back().shininess;
+		else if (keyword == "d")
+			stream >> materials.back().opacity;
+		else if (keyword == "Tr")
+		{
+			float transparency = 0.0f;
+			stream >> transparency;
+			materials.back().opacity = 1.0f - transparency;
+		}
+		else if (keyword == "map_Kd")
+		{
+			// Options like -s come first, the file name is the last word
+			std::string word;
+			while (stream >> word)
+				materials.back().diffuseMap = word;
+			if (!materials.back().diffuseMap.empty())
+				materials.back().diffuseMap = directoryOf(path) + materials.back().diffuseMap;
+		}
+	}
+
+	return materials;
+}
+
+void loadMaterials(std::vector<Material> &materials, const std::vector<std::string> &libraries)
+{
+	for (const std::string &library : libraries)
+	{
+		std::vector<Material> parsed;
+
+		try
+		{
+			parsed = parseMtl(library);
+		}
+		catch (const std::runtime_error &e)
+		{
+			std::cerr << e.what() << std::endl;
+			continue;
+		}
+
+		for (Material &material : materials)
+		{
+			for (Material &found : parsed)
+			{
+				if (found.name == material.name)
+				{
+					material = std::move(found);
+					break;
+				}
+			}
+		}
+	}
+
+	for (Material &material : materials)
+	{
+		if (material.diffuseMap.empty())
+			continue;
+
+		try
+		{
+			material.diffuseImage = loadImage(material.diffuseMap);
+		}
+		catch (const std::runtime_error &e)
+		{
+			std::cerr << e.what() << std::endl;
+		}
+	}
+}
\ No newline at end of file
@@ -1,14 +1,157 @@
 #include "engine/Mesh.hpp"
-#include <fstream>
-#include <sstream>
+#include "engine/ObjParser.hpp"
+#include "engine/MeshCache.hpp"
+#include "engine/Frustum.hpp"
+#include "engine/Meshlets.hpp"
+#include "engine/Normals.hpp"
+#include "engine/Simplify.hpp"
+#include "engine/VertexCache.hpp"
+#include "engine/VertexFormat.hpp"
+#include "maths/Utils.hpp"
+#include "maths/Vec3Array.hpp"
+#include "utils/FileSystem.hpp"
+#include "utils/Parallel.hpp"
 #include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
 #include <limits>
+#include <mutex>
+#include <stdexcept>
+
+Mesh::Mesh() : VAO(0), VBO(0), EBO(0), vertexCapacity(0), indexCapacity(0), format(VertexFormat::Full),
+			   instanceVBO(0), instanceCapacity(0), instanceCount(0),
+			   boundingBox(), center(), size(), positionScale(1.0f), positionOffset() {}
+
+Mesh::Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices) : VAO(0), VBO(0), EBO(0),
+																			  vertexCapacity(0), indexCapacity(0),
+																			  format(VertexFormat::Full), instanceVBO(0),
+																			  instanceCapacity(0), instanceCount(0),
+																			  vertices(std::move(vertices)),
+																			  indices(std::move(indices)),
+																			  positionScale(1.0f), positionOffset()
+{
+	boundingBox.min = Vec3(std::numeric_limits<float>::max());
+	boundingBox.max = Vec3(std::numeric_limits<float>::lowest());
+
+	// Positions are copied into a small structure of arrays a block at a time,
+	// so the reduction runs on full registers without a copy of the whole mesh
+	std::mutex boundsMutex;
+	Parallel::forRange(this->vertices.size(), 1 << 16, [&](size_t first, size_t last)
+	{
+		const size_t blockSize = 1024;
+		Vec3Array block;
+		Vec3 min = Vec3(std::numeric_limits<float>::max());
+		Vec3 max = Vec3(std::numeric_limits<float>::lowest());
+
+		for (size_t begin = first; begin < last; begin += blockSize)
+		{
+			block.assign(&this->vertices[begin].position, std::min(blockSize, last - begin), sizeof(Vertex));
+			block.bounds(min, max);
+		}
+
+		std::lock_guard<std::mutex> lock(boundsMutex);
+		boundingBox.min = Vec3(std::min(boundingBox.min.x, min.x), std::min(boundingBox.min.y, min.y), std::min(boundingBox.min.z, min.z));
+		boundingBox.max = Vec3(std::max(boundingBox.max.x, max.x), std::max(boundingBox.max.y, max.y), std::max(boundingBox.max.z, max.z));
+	});
+
+	this->center = (boundingBox.min + boundingBox.max) / 2.0f;
+	this->size = (boundingBox.max - boundingBox.min).magnitude();
+}
+
+Mesh::Mesh(const Vertex *vertices, size_t vertexCount, const unsigned int *indices, size_t indexCount,
+		   const BoundingBox &boundingBox, const Vec3 &center, float size) : VAO(0), VBO(0), EBO(0),
+																			 vertexCapacity(0), indexCapacity(0),
+																			 format(VertexFormat::Full), instanceVBO(0),
+																			 instanceCapacity(0), instanceCount(0),
+																			 vertices(vertices, vertices + vertexCount),
+																			 indices(indices, indices + indexCount),
+																			 boundingBox(boundingBox),
+																			 center(center),
+																			 size(size),
+																			 positionScale(1.0f), positionOffset()
+{
+}
+
+Mesh::Mesh(Mesh &&mesh) noexcept : VAO(mesh.VAO), VBO(mesh.VBO), EBO(mesh.EBO),
+								   vertexCapacity(mesh.vertexCapacity), indexCapacity(mesh.indexCapacity),
+								   format(mesh.format),
+								   instanceVBO(mesh.instanceVBO),
+								   instanceCapacity(mesh.instanceCapacity), instanceCount(mesh.instanceCount),
+								   vertices(std::move(mesh.vertices)),
+								   indices(std::move(mesh.indices)),
+								   lods(std::move(mesh.lods)),
+								   meshlets(std::move(mesh.meshlets)),
+								   submeshes(std::move(mesh.submeshes)),
+								   materials(std::move(mesh.materials)),
+								   materialLibraries(std::move(mesh.materialLibraries)),
+								   boundingBox(mesh.boundingBox),
+								   center(mesh.center),
+								   size(mesh.size),
+								   positionScale(mesh.positionScale),
+								   positionOffset(mesh.positionOffset)
+{
+	mesh.VAO = mesh.VBO = mesh.EBO = mesh.instanceVBO = 0;
+}
+
+Mesh &Mesh::operator=(Mesh &&mesh) noexcept
+{
+	if (this != &mesh)
+	{
+		release();
+
+		VAO = mesh.VAO;
+		VBO = mesh.VBO;
+		EBO = mesh.EBO;
+		vertexCapacity = mesh.vertexCapacity;
+		indexCapacity = mesh.indexCapacity;
+		format = mesh.format;
+		instanceVBO = mesh.instanceVBO;
+		instanceCapacity = mesh.instanceCapacity;
+		instanceCount = mesh.instanceCount;
+		vertices = std::move(mesh.vertices);
+		indices = std::move(mesh.indices);
+		lods = std::move(mesh.lods);
+		meshlets = std::move(mesh.meshlets);
+		submeshes = std::move(mesh.submeshes);
+		materials = std::move(mesh.materials);
+		materialLibraries = std::move(mesh.materialLibraries);
+		boundingBox = mesh.boundingBox;
+		center = mesh.center;
+		size = mesh.size;
+		positionScale = mesh.positionScale;
+		positionOffset = mesh.positionOffset;
+
+		mesh.VAO = mesh.VBO = mesh.EBO = mesh.instanceVBO = 0;
+	}
+	return *this;
+}
 
-Mesh::Mesh() : VAO(0), VBO(0), EBO(0), boundingBox(), center(), size() {}
+Mesh::~Mesh()
+{
+	release();
+}
+
+void Mesh::release()
+{
+	if (!VAO)
+		return;
+
+	glDeleteVertexArrays(1, &VAO);
+	glDeleteBuffers(1, &VBO);
+	glDeleteBuffers(1, &EBO);
+	if (instanceVBO)
+		glDeleteBuffers(1, &instanceVBO);
+	VAO = VBO = EBO = instanceVBO = 0;
+	vertexCapacity = indexCapacity = instanceCapacity = instanceCount = 0;
+}
 
-Mesh::Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices) : vertices(vertices),
-																			  indices(indices)
+void Mesh::upload()
 {
+	if (VAO)
+		return;
+
 	glGenVertexArrays(1, &VAO);
 	glGenBuffers(1, &VBO);
 	glGenBuffers(1, &EBO);
@@ -16,197 +159,725 @@ Mesh::Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices) : ve
 	glBindVertexArray(VAO);
 
 	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), vertices.data(), GL_STATIC_DRAW);
+	vertexCapacity = vertices.size();
+
+	// Levels of detail follow the full mesh in the same index buffer
+	indexCapacity = indices.size();
+	for (const MeshLod &lod : lods)
+		indexCapacity += lod.indices.size();
 
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
-
-	// Vertex Attributes
-	// Position
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)0);
-	glEnableVertexAttribArray(0);
-	// UV coordinates
-	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, texCoords));
-	glEnableVertexAttribArray(1);
-	// Normal
-	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, normal));
-	glEnableVertexAttribArray(2);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCapacity * sizeof(unsigned int), nullptr, GL_STATIC_DRAW);
+	glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, indices.size() * sizeof(unsigned int), indices.data());
+	for (size_t i = 0, offset = indices.size(); i < lods.size(); offset += lods[i++].indices.size())
+		glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, offset * sizeof(unsigned int), lods[i].indices.size() * sizeof(unsigned int), lods[i].indices.data());
+
+	if (format == VertexFormat::Packed)
+	{
+		const std::vector<PackedVertex> packed = packVertices(vertices, boundingBox);
+		glBufferData(GL_ARRAY_BUFFER, packed.size() * sizeof(PackedVertex), packed.data(), GL_STATIC_DRAW);
+
+		positionScale = quantizationScale(boundingBox);
+		positionOffset = boundingBox.min;
+
+		// Vertex Attributes
+		// Position, normalized to [0, 1] within the bounding box
+		glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(PackedVertex), (void *)offsetof(PackedVertex, position));
+		glEnableVertexAttribArray(0);
+		// UV coordinates
+		glVertexAttribPointer(1, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(PackedVertex), (void *)offsetof(PackedVertex, texCoords));
+		glEnableVertexAttribArray(1);
+		// Normal, packed formats always have 4 components
+		glVertexAttribPointer(2, 4, GL_INT_2_10_10_10_REV, GL_TRUE, sizeof(PackedVertex), (void *)offsetof(PackedVertex, normal));
+		glEnableVertexAttribArray(2);
+	}
+	else
+	{
+		glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), vertices.data(), GL_STATIC_DRAW);
+
+		positionScale = Vec3(1.0f);
+		positionOffset = Vec3(0.0f);
+
+		// Vertex Attributes
+		// Position
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)0);
+		glEnableVertexAttribArray(0);
+		// UV coordinates
+		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, texCoords));
+		glEnableVertexAttribArray(1);
+		// Normal
+		glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, normal));
+		glEnableVertexAttribArray(2);
+	}
 
 	glBindVertexArray(0);
 
-	boundingBox.min = Vec3(std::numeric_limits<float>::max());
-	boundingBox.max = Vec3(std::numeric_limits<float>::min());
+	for (Material &material : materials)
+	{
+		if (!material.diffuseImage.pixels)
+			continue;
+
+		material.diffuseTexture = Texture(material.diffuseImage);
+		material.diffuseImage = Image();
+		material.textured = true;
+	}
+}
+
+void Mesh::bindInstances()
+{
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
 
-	for (const Vertex &vertex : vertices)
+	// A mat4 attribute takes four locations, one per column
+	for (unsigned int column = 0; column < 4; column++)
 	{
-		if (vertex.position.x < boundingBox.min.x)
-			boundingBox.min.x = vertex.position.x;
-		if (vertex.position.y < boundingBox.min.y)
-			boundingBox.min.y = vertex.position.y;
-		if (vertex.position.z < boundingBox.min.z)
-			boundingBox.min.z = vertex.position.z;
+		glVertexAttribPointer(3 + column, 4, GL_FLOAT, GL_FALSE, sizeof(Mat4), (void *)(column * 4 * sizeof(float)));
+		glEnableVertexAttribArray(3 + column);
+		glVertexAttribDivisor(3 + column, 1);
+	}
+
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void Mesh::setInstances(const std::vector<Transform> &transforms)
+{
+	if (!VAO)
+		return;
 
-		if (vertex.position.x > boundingBox.max.x)
-			boundingBox.max.x = vertex.position.x;
-		if (vertex.position.y > boundingBox.max.y)
-			boundingBox.max.y = vertex.position.y;
-		if (vertex.position.z > boundingBox.max.z)
-			boundingBox.max.z = vertex.position.z;
+	std::vector<Mat4> columns(transforms.size());
+	for (size_t i = 0; i < transforms.size(); i++)
+		columns[i] = transforms[i].toMat4().transpose();
+
+	if (!instanceVBO)
+		glGenBuffers(1, &instanceVBO);
+
+	// The buffer is rewritten every frame, it only grows so its name and the
+	// vertex array state stay valid
+	glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+	if (columns.size() > instanceCapacity)
+	{
+		instanceCapacity = std::max(columns.size(), instanceCapacity * 2);
+		glBufferData(GL_ARRAY_BUFFER, instanceCapacity * sizeof(Mat4), nullptr, GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		bindInstances();
+		glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
 	}
+	glBufferSubData(GL_ARRAY_BUFFER, 0, columns.size() * sizeof(Mat4), columns.data());
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-	this->center = (boundingBox.min + boundingBox.max) / 2.0f;
-	this->size = (boundingBox.max - boundingBox.min).magnitude();
+	instanceCount = columns.size();
+}
+
+void Mesh::generateLods()
+{
+	lods = buildLodChain(vertices, indices, submeshes);
+
+	for (MeshLod &lod : lods)
+	{
+		for (size_t i = 0; i < submeshes.size(); i++)
+			optimizeVertexCache(lod.indices.data() + lod.submeshOffsets[i], lod.submeshOffsets[i + 1] - lod.submeshOffsets[i]);
+	}
+}
+
+void Mesh::generateMeshlets()
+{
+	meshlets = buildMeshlets(vertices, indices, submeshes);
+}
+
+size_t Mesh::selectLod(float scale, float distance, float pixelsPerUnit, float threshold) const
+{
+	// Errors are measured from the nearest the surface can get to the camera
+	const float nearest = std::max(distance - size * scale * 0.5f, 1e-3f);
+	size_t lod = 0;
+
+	for (size_t i = 0; i < lods.size(); i++)
+	{
+		if (lods[i].error * scale / nearest * pixelsPerUnit <= threshold)
+			lod = i + 1;
+	}
+	return lod;
+}
+
+void Mesh::setFormat(VertexFormat format)
+{
+	if (format == this->format)
+		return;
+
+	this->format = format;
+	if (VAO)
+	{
+		release();
+		upload();
+	}
+}
+
+void Mesh::append(const Mesh &chunk)
+{
+	const size_t firstVertex = vertices.size();
+	const size_t firstIndex = indices.size();
+
+	if (chunk.vertices.empty())
+		return;
+
+	lods.clear();
+	meshlets.clear();
+	submeshes.clear();
+	setFormat(VertexFormat::Full);
+
+	vertices.insert(vertices.end(), chunk.vertices.begin(), chunk.vertices.end());
+	indices.reserve(indices.size() + chunk.indices.size());
+	for (unsigned int index : chunk.indices)
+		indices.push_back(firstVertex + index);
+
+	if (firstVertex == 0)
+		boundingBox = chunk.boundingBox;
+	else
+	{
+		boundingBox.min.x = std::min(boundingBox.min.x, chunk.boundingBox.min.x);
+		boundingBox.min.y = std::min(boundingBox.min.y, chunk.boundingBox.min.y);
+		boundingBox.min.z = std::min(boundingBox.min.z, chunk.boundingBox.min.z);
+		boundingBox.max.x = std::max(boundingBox.max.x, chunk.boundingBox.max.x);
+		boundingBox.max.y = std::max(boundingBox.max.y, chunk.boundingBox.max.y);
+		boundingBox.max.z = std::max(boundingBox.max.z, chunk.boundingBox.max.z);
+	}
+
+	center = (boundingBox.min + boundingBox.max) / 2.0f;
+	size = (boundingBox.max - boundingBox.min).magnitude();
+
+	if (!VAO)
+	{
+		upload();
+		return;
+	}
+
+	// Buffers grow geometrically and are refilled from the CPU copy, keeping
+	// the same names so the vertex array state stays valid
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	if (vertices.size() > vertexCapacity)
+	{
+		vertexCapacity = std::max(vertices.size(), vertexCapacity * 2);
+		glBufferData(GL_ARRAY_BUFFER, vertexCapacity * sizeof(Vertex), nullptr, GL_STATIC_DRAW);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, vertices.size() * sizeof(Vertex), vertices.data());
+	}
+	else
+		glBufferSubData(GL_ARRAY_BUFFER, firstVertex * sizeof(Vertex), chunk.vertices.size() * sizeof(Vertex), chunk.vertices.data());
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	glBindVertexArray(VAO);
+	if (indices.size() > indexCapacity)
+	{
+		indexCapacity = std::max(indices.size(), indexCapacity * 2);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCapacity * sizeof(unsigned int), nullptr, GL_STATIC_DRAW);
+		glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, indices.size() * sizeof(unsigned int), indices.data());
+	}
+	else
+		glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, firstIndex * sizeof(unsigned int), chunk.indices.size() * sizeof(unsigned int), indices.data() + firstIndex);
+	glBindVertexArray(0);
 }
 
-void Mesh::draw()
+void Mesh::draw(size_t lod)
 {
+	size_t first = 0;
+	size_t count = indices.size();
+
+	for (size_t i = 0; i < lod && i < lods.size(); i++)
+	{
+		first += count;
+		count = lods[i].indices.size();
+	}
+
 	glBindVertexArray(VAO);
-	glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
+	glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, (void *)(first * sizeof(unsigned int)));
 	glBindVertexArray(0);
 }
 
-Mesh loadMesh(const std::string &path)
+void Mesh::draw(const Mat4 &modelViewProjection, size_t lod, const MaterialBinder &bindMaterial)
 {
-	std::vector<Vertex> vertices;
-	std::vector<unsigned int> indices;
+	lod = std::min(lod, lods.size());
 
-	std::vector<Vec3> positions;
-	std::vector<Vec2> uvs;
-	std::vector<Vec3> normals;
-	std::vector<unsigned int> vertexIndices, uvIndices, normalIndices;
+	if (submeshes.empty())
+	{
+		draw(lod);
+		return;
+	}
 
-	std::ifstream file(path);
+	size_t levelStart = 0;
+	for (size_t i = 0; i < lod; i++)
+		levelStart += i == 0 ? indices.size() : lods[i - 1].indices.size();
 
-	if (!file.is_open())
-		throw std::runtime_error("Failed to open file: " + path);
+	const Frustum frustum(modelViewProjection);
+	drawCounts.clear();
+	drawOffsets.clear();
 
-	std::string line;
+	glBindVertexArray(VAO);
 
-	while (std::getline(file, line))
+	// Submeshes are sorted by material: each material is bound once, for a
+	// single draw of all of its visible ranges
+	for (size_t i = 0; i < submeshes.size(); i++)
 	{
-		std::istringstream stream(line);
-		std::string type;
-		stream >> type;
+		const Submesh &submesh = submeshes[i];
+
+		if (frustum.containsBox(submesh.boundingBox.min, submesh.boundingBox.max))
+		{
+			if (lod == 0 && submesh.meshletCount)
+				cullMeshlets(&meshlets[submesh.firstMeshlet], submesh.meshletCount, frustum, drawCounts, drawOffsets);
+			else
+			{
+				const size_t first = lod == 0 ? submesh.firstIndex : lods[lod - 1].submeshOffsets[i];
+				const size_t last = lod == 0 ? submesh.firstIndex + submesh.indexCount : lods[lod - 1].submeshOffsets[i + 1];
+				const void *offset = (const void *)((levelStart + first) * sizeof(unsigned int));
+
+				if (!drawCounts.empty() && (const char *)drawOffsets.back() + drawCounts.back() * sizeof(unsigned int) == offset)
+					drawCounts.back() += last - first;
+				else if (last > first)
+				{
+					drawCounts.push_back(last - first);
+					drawOffsets.push_back(offset);
+				}
+			}
+		}
 
-		if (type == "v")
+		if (i + 1 < submeshes.size() && submeshes[i + 1].material == submesh.material)
+			continue;
+
+		if (!drawCounts.empty())
 		{
-			Vec3 position;
-			stream >> position.x >> position.y >> position.z;
-			positions.push_back(position);
+			if (bindMaterial)
+				bindMaterial(materials[submesh.material]);
+			glMultiDrawElements(GL_TRIANGLES, drawCounts.data(), GL_UNSIGNED_INT, drawOffsets.data(), drawCounts.size());
 		}
-		else if (type == "vt")
+		drawCounts.clear();
+		drawOffsets.clear();
+	}
+
+	glBindVertexArray(0);
+}
+
+void Mesh::drawInstanced(size_t lod, const MaterialBinder &bindMaterial)
+{
+	if (!instanceCount)
+		return;
+
+	lod = std::min(lod, lods.size());
+
+	size_t levelStart = 0;
+	for (size_t i = 0; i < lod; i++)
+		levelStart += i == 0 ? indices.size() : lods[i - 1].indices.size();
+	const size_t levelSize = lod == 0 ? indices.size() : lods[lod - 1].indices.size();
+
+	glBindVertexArray(VAO);
+
+	if (submeshes.empty())
+		glDrawElementsInstanced(GL_TRIANGLES, levelSize, GL_UNSIGNED_INT, (void *)(levelStart * sizeof(unsigned int)), instanceCount);
+
+	// Submeshes sharing a material are contiguous at every level, so each
+	// material is a single range
+	for (size_t i = 0, first = 0; i < submeshes.size(); i++)
+	{
+		if (i + 1 < submeshes.size() && submeshes[i + 1].material == submeshes[i].material)
+			continue;
+
+		size_t last = levelSize;
+		if (i + 1 < submeshes.size())
+			last = lod == 0 ? submeshes[i + 1].firstIndex : lods[lod - 1].submeshOffsets[i + 1];
+
+		if (last > first)
 		{
-			Vec2 uv;
-			stream >> uv.x >> uv.y;
-			uvs.push_back(uv);
+			if (bindMaterial)
+				bindMaterial(materials[submeshes[i].material]);
+			glDrawElementsInstanced(GL_TRIANGLES, last - first, GL_UNSIGNED_INT,
+									(void *)((levelStart + first) * sizeof(unsigned int)), instanceCount);
 		}
-		else if (type == "vn")
+		first = last;
+	}
+
+	glBindVertexArray(0);
+}
+
+namespace
+{
+	inline size_t hashCorner(const ObjCorner &corner)
+	{
+		uint64_t hash = (uint32_t)corner.position * 0x9E3779B97F4A7C15ull;
+		hash ^= (uint32_t)corner.uv * 0xC2B2AE3D27D4EB4Full;
+		hash ^= (uint32_t)corner.normal * 0x165667B19E3779F9ull;
+		return hash ^ (hash >> 32);
+	}
+
+	inline bool operator==(const ObjCorner &a, const ObjCorner &b)
+	{
+		return a.position == b.position && a.uv == b.uv && a.normal == b.normal;
+	}
+
+	// Welds identical corners into a single vertex, in order of first appearance.
+	// The linear-probing table is sized for the case where nothing is shared, so
+	// it never grows and stays at most half full.
+	std::vector<ObjCorner> weldCorners(const std::vector<ObjCorner> &corners, std::vector<unsigned int> &indices)
+	{
+		const unsigned int empty = std::numeric_limits<unsigned int>::max();
+		size_t capacity = 16;
+		while (capacity < corners.size() * 2)
+			capacity *= 2;
+
+		std::vector<unsigned int> slots(capacity, empty);
+		std::vector<ObjCorner> unique;
+		const size_t mask = capacity - 1;
+
+		indices.resize(corners.size());
+
+		for (size_t i = 0; i < corners.size(); i++)
 		{
-			Vec3 normal;
-			stream >> normal.x >> normal.y >> normal.z;
-			normals.push_back(normal);
+			const ObjCorner &corner = corners[i];
+			size_t slot = hashCorner(corner) & mask;
+
+			while (slots[slot] != empty && !(unique[slots[slot]] == corner))
+				slot = (slot + 1) & mask;
+
+			if (slots[slot] == empty)
+			{
+				slots[slot] = unique.size();
+				unique.push_back(corner);
+			}
+
+			indices[i] = slots[slot];
 		}
-		else if (type == "f")
+
+		return unique;
+	}
+
+	// Generated normals are smoothed across edges flatter than this
+	const float creaseAngle = maths::radians(60.0f);
+
+	// Set SCOP_MESH_STATS (to anything but 0) to print how well built meshes
+	// use the vertex cache, which costs two more passes over their indices
+	bool meshStatsEnabled()
+	{
+		static const bool enabled = []()
 		{
-			std::string vertex;
-			uint32_t indices[4][3] = {{0}};
-			int indexCount = 0;
+			const char *value = std::getenv("SCOP_MESH_STATS");
+			return value && *value && std::string(value) != "0";
+		}();
+		return enabled;
+	}
+
+	unsigned int materialIndex(std::vector<Material> &materials, const std::string &name)
+	{
+		for (size_t i = 0; i < materials.size(); i++)
+		{
+			if (materials[i].name == name)
+				return i;
+		}
+
+		materials.push_back(Material(name));
+		return materials.size() - 1;
+	}
 
-			while (stream >> vertex && indexCount < 4)
+	// Cuts the corners into parts wherever an o, g or usemtl statement appears,
+	// leaving out empty ones. Ranges are in corners, which become indices 1:1.
+	std::vector<Submesh> splitGroups(const ObjData &data, std::vector<Material> &materials)
+	{
+		std::vector<Submesh> submeshes;
+		std::string name, material;
+		size_t first = 0;
+
+		auto close = [&](size_t end)
+		{
+			if (end > first)
 			{
-				std::istringstream vertexStream(vertex);
-				std::string index;
+				Submesh submesh = Submesh();
+				submesh.name = name;
+				submesh.material = materialIndex(materials, material);
+				submesh.firstIndex = first;
+				submesh.indexCount = end - first;
+				submeshes.push_back(submesh);
+			}
+			first = end;
+		};
 
-				for (int j = 0; j < 3 && std::getline(vertexStream, index, '/'); j++)
-				{
-					if (index.empty())
-						continue;
+		for (const ObjGroup &group : data.groups)
+		{
+			close(group.firstCorner);
+			(group.setsMaterial ? material : name) = group.value;
+		}
+		close(data.corners.size());
 
-					const unsigned int indexValue = std::stoi(index);
-					indices[indexCount][j] = indexValue;
-				}
+		return submeshes;
+	}
+
+	// Puts the corners of submeshes sharing a material next to each other
+	void sortByMaterial(std::vector<Submesh> &submeshes, std::vector<ObjCorner> &corners)
+	{
+		auto byMaterial = [](const Submesh &a, const Submesh &b)
+		{
+			return a.material < b.material;
+		};
+
+		if (std::is_sorted(submeshes.begin(), submeshes.end(), byMaterial))
+			return;
+
+		std::stable_sort(submeshes.begin(), submeshes.end(), byMaterial);
+
+		std::vector<ObjCorner> sorted;
+		sorted.reserve(corners.size());
+		for (Submesh &submesh : submeshes)
+		{
+			const size_t first = submesh.firstIndex;
+			submesh.firstIndex = sorted.size();
+			sorted.insert(sorted.end(), corners.begin() + first, corners.begin() + first + submesh.indexCount);
+		}
+		corners.swap(sorted);
+	}
+
+	Mesh buildMesh(const std::string &path, ObjData &data, bool withLods)
+	{
+		std::vector<Vertex> vertices;
+		std::vector<unsigned int> indices;
+
+		const size_t positionCount = data.positions.size();
+		const size_t uvCount = data.uvs.size();
+		const size_t normalCount = data.normals.size();
 
-				indexCount++;
+		std::atomic<bool> invalidIndex(false);
+
+		// Out of range positions are an error, other attributes are just dropped
+		Parallel::forRange(data.corners.size(), 1 << 16, [&](size_t first, size_t last)
+		{
+			for (size_t i = first; i < last; i++)
+			{
+				ObjCorner &corner = data.corners[i];
+
+				if (corner.position < 0 || (size_t)corner.position >= positionCount)
+					invalidIndex = true;
+				if ((size_t)corner.uv >= uvCount)
+					corner.uv = -1;
+				if ((size_t)corner.normal >= normalCount)
+					corner.normal = -1;
 			}
+		});
+
+		if (invalidIndex)
+			throw std::runtime_error("Invalid vertex index in file: " + path);
+
+		// Generate normals if they doesn't exist
+		if (data.normals.empty())
+			generateNormals(data, creaseAngle);
+
+		std::vector<Material> materials;
+		std::vector<Submesh> submeshes = splitGroups(data, materials);
+		sortByMaterial(submeshes, data.corners);
+
+		std::vector<ObjCorner> corners = weldCorners(data.corners, indices);
+
+		// Triangles come in file order, reorder them for the post-transform
+		// cache, within their submesh, and then the vertices for fetch locality
+		const bool stats = meshStatsEnabled();
+		VertexCacheStats before = {};
+		if (stats)
+			before = analyzeVertexCache(indices, corners.size());
+		if (submeshes.size() == 1)
+			optimizeVertexCache(indices, corners.size());
+		else
+		{
+			Parallel::forRange(submeshes.size(), 1, [&](size_t first, size_t last)
+			{
+				for (size_t i = first; i < last; i++)
+					optimizeVertexCache(indices.data() + submeshes[i].firstIndex, submeshes[i].indexCount);
+			});
+		}
+		const std::vector<unsigned int> order = optimizeVertexFetch(indices, corners.size());
+
+		if (stats)
+		{
+			const VertexCacheStats after = analyzeVertexCache(indices, order.size());
+			std::cout << std::fixed << std::setprecision(3)
+					  << "Vertex cache: ACMR " << before.acmr << " -> " << after.acmr
+					  << ", ATVR " << before.atvr << " -> " << after.atvr << std::defaultfloat << std::endl;
+		}
 
-			for (int i = 0; i < 3; i++)
+		vertices.resize(order.size());
+
+		Parallel::forRange(order.size(), 1 << 16, [&](size_t first, size_t last)
+		{
+			for (size_t i = first; i < last; i++)
 			{
-				for (int j = 0; j < 3; j++)
-				{
-					const uint32_t indexValue = indices[i][j] - 1;
+				const ObjCorner &corner = corners[order[i]];
+				Vertex &vertex = vertices[i];
 
-					if (indices[i][j] == 0)
-						continue;
+				vertex.position = data.positions[corner.position];
 
-					if (j == 0)
-						vertexIndices.push_back(indexValue);
-					else if (j == 1)
-						uvIndices.push_back(indexValue);
-					else if (j == 2)
-						normalIndices.push_back(indexValue);
-				}
+				if (corner.uv >= 0)
+					vertex.texCoords = data.uvs[corner.uv];
+
+				if (corner.normal >= 0)
+					vertex.normal = data.normals[corner.normal];
 			}
+		});
 
-			if (indexCount > 3)
+		Parallel::forRange(submeshes.size(), 1, [&](size_t first, size_t last)
+		{
+			for (size_t i = first; i < last; i++)
 			{
-				for (int i = 0; i < 3; i++)
+				Submesh &submesh = submeshes[i];
+				BoundingBox &box = submesh.boundingBox;
+				box.min = box.max = vertices[indices[submesh.firstIndex]].position;
+
+				for (size_t j = submesh.firstIndex; j < submesh.firstIndex + submesh.indexCount; j++)
 				{
-					const int index = (i + 2) % 4;
-					for (int j = 0; j < 3; j++)
-					{
-						const uint32_t indexValue = indices[index][j] - 1;
-
-						if (indices[index][j] == 0)
-							continue;
-
-						if (j == 0)
-							vertexIndices.push_back(indexValue);
-						else if (j == 1)
-							uvIndices.push_back(indexValue);
-						else if (j == 2)
-							normalIndices.push_back(indexValue);
-					}
+					const Vec3 &p = vertices[indices[j]].position;
+					box.min = Vec3(std::min(box.min.x, p.x), std::min(box.min.y, p.y), std::min(box.min.z, p.z));
+					box.max = Vec3(std::max(box.max.x, p.x), std::max(box.max.y, p.y), std::max(box.max.z, p.z));
 				}
 			}
+		});
+
+		// Libraries are looked up next to the OBJ
+		const size_t slash = path.find_last_of('/');
+		const std::string directory = slash == std::string::npos ? "" : path.substr(0, slash + 1);
+
+		Mesh mesh(std::move(vertices), std::move(indices));
+		mesh.submeshes = std::move(submeshes);
+		mesh.materials = std::move(materials);
+		for (const std::string &library : data.materialLibraries)
+			mesh.materialLibraries.push_back(directory + library);
+		if (withLods)
+			mesh.generateLods();
+
+#ifdef DEBUG
+		if (!mesh.lods.empty())
+		{
+			std::cout << "Levels of detail: " << mesh.indices.size() / 3;
+			for (const MeshLod &lod : mesh.lods)
+				std::cout << " -> " << lod.indices.size() / 3;
+			std::cout << " triangles" << std::endl;
 		}
+#endif
+
+		return mesh;
 	}
 
-	for (unsigned int i = 0; i < vertexIndices.size(); i++)
+	// Unwelded triangles of the corners [first, end) whose positions are known
+	// so far, with flat normals when the file has none yet
+	Mesh previewCorners(const ObjData &data, size_t first)
 	{
-		Vertex vertex;
+		std::vector<Vertex> vertices;
+		std::vector<unsigned int> indices;
+
+		const size_t positionCount = data.positions.size();
+		const size_t uvCount = data.uvs.size();
+		const size_t normalCount = data.normals.size();
+
+		vertices.reserve(data.corners.size() - first);
+		indices.reserve(data.corners.size() - first);
+
+		for (size_t i = first; i + 2 < data.corners.size(); i += 3)
+		{
+			const ObjCorner *corners = &data.corners[i];
 
-		vertex.position = positions[vertexIndices[i]];
+			if ((size_t)corners[0].position >= positionCount || (size_t)corners[1].position >= positionCount ||
+				(size_t)corners[2].position >= positionCount)
+				continue;
 
-		if (!uvs.empty() && i < uvIndices.size())
-			vertex.texCoords = uvs[uvIndices[i]];
+			Vec3 faceNormal;
+			if (normalCount == 0)
+			{
+				Vec3 u = data.positions[corners[1].position] - data.positions[corners[0].position];
+				Vec3 v = data.positions[corners[2].position] - data.positions[corners[0].position];
+				faceNormal = u.cross(v).normalize();
+			}
 
-		if (!normals.empty() && i < normalIndices.size())
-			vertex.normal = normals[normalIndices[i]];
+			for (int j = 0; j < 3; j++)
+			{
+				Vertex vertex;
+
+				vertex.position = data.positions[corners[j].position];
+				if ((size_t)corners[j].uv < uvCount)
+					vertex.texCoords = data.uvs[corners[j].uv];
+				vertex.normal = (size_t)corners[j].normal < normalCount ? data.normals[corners[j].normal] : faceNormal;
+
+				indices.push_back(vertices.size());
+				vertices.push_back(vertex);
+			}
+		}
 
-		vertices.push_back(vertex);
-		indices.push_back(i);
+		return Mesh(std::move(vertices), std::move(indices));
 	}
 
-	// Generate normals if they doesn't exist
-	if (normals.empty())
+	// Below this size a file parses faster than a preview would help
+	const size_t streamingThreshold = 8 << 20;
+	// Pieces start small to get triangles on screen quickly, then grow
+	const size_t firstPieceSize = 1 << 20;
+	const size_t maximumPieceSize = 32 << 20;
+
+	ObjData streamObj(const FileSystem::MappedFile &file, std::atomic<float> *progress, const MeshPreview &preview)
 	{
-		for (uint32_t i = 0; i < indices.size(); i += 3)
+		ObjData data;
+		size_t pieceSize = firstPieceSize;
+
+		for (const char *cursor = file.begin(); cursor < file.end();)
 		{
-			Vec3 a = vertices[indices[i]].position;
-			Vec3 b = vertices[indices[i + 1]].position;
-			Vec3 c = vertices[indices[i + 2]].position;
+			const char *pieceEnd = file.begin() + std::min(file.size(), (size_t)(cursor - file.begin()) + pieceSize);
+			while (pieceEnd < file.end() && pieceEnd[-1] != '\n')
+				pieceEnd++;
+
+			ObjOffsets offsets;
+			offsets.positions = data.positions.size();
+			offsets.uvs = data.uvs.size();
+			offsets.normals = data.normals.size();
+
+			ObjData piece = parseObj(cursor, pieceEnd, offsets);
+			const size_t firstCorner = data.corners.size();
+
+			data.positions.insert(data.positions.end(), piece.positions.begin(), piece.positions.end());
+			data.uvs.insert(data.uvs.end(), piece.uvs.begin(), piece.uvs.end());
+			data.normals.insert(data.normals.end(), piece.normals.begin(), piece.normals.end());
+			for (ObjGroup &group : piece.groups)
+			{
+				group.firstCorner += firstCorner;
+				data.groups.push_back(std::move(group));
+			}
+			data.materialLibraries.insert(data.materialLibraries.end(), piece.materialLibraries.begin(), piece.materialLibraries.end());
+			data.corners.insert(data.corners.end(), piece.corners.begin(), piece.corners.end());
+			data.relativeIndices = data.relativeIndices || piece.relativeIndices;
 
-			Vec3 u = b - a;
-			Vec3 v = c - a;
+			Mesh chunk = previewCorners(data, firstCorner);
+			if (!chunk.vertices.empty())
+				preview(std::move(chunk));
 
-			Vec3 normal = u.cross(v);
-			normal.normalize();
+			cursor = pieceEnd;
+			pieceSize = std::min(pieceSize * 2, maximumPieceSize);
 
-			vertices[indices[i]].normal = normal;
-			vertices[indices[i + 1]].normal = normal;
-			vertices[indices[i + 2]].normal = normal;
+			if (progress)
+				progress->store((float)(cursor - file.begin()) / (float)file.size());
 		}
+
+		return data;
+	}
+}
+
+Mesh loadMesh(const std::string &path, std::atomic<float> *progress, const MeshPreview &preview, bool withLods)
+{
+	Mesh mesh;
+
+	if (MeshCache::load(path, mesh))
+	{
+		if (!withLods)
+			mesh.lods.clear();
+	}
+	else
+	{
+		FileSystem::MappedFile file(path);
+		ObjData data = preview && file.size() >= streamingThreshold ? streamObj(file, progress, preview)
+																	: parseObj(file.begin(), file.end(), ObjOffsets(), progress);
+		mesh = buildMesh(path, data, withLods);
+		// A cached mesh without its lods would stand in for one with them later
+		if (withLods)
+			MeshCache::store(path, file, mesh);
 	}
 
-	return Mesh(vertices, indices);
+	// A single pass over the indices, cheaper to redo than to cache
+	mesh.generateMeshlets();
+	// Read every time, so edits to the MTL show without invalidating the cache
+	loadMaterials(mesh.materials, mesh.materialLibraries);
+	return mesh;
 }
\ No newline at end of file
@@ -0,0 +1,417 @@
+#include "engine/MeshCache.hpp"
+#include "utils/Hash.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+#include <climits>
+#include <cstddef>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+namespace MeshCache
+{
+
+	namespace
+	{
+		// Bump whenever the layout below or the meaning of its content changes
+		const uint32_t version = 5;
+		const char magic[8] = {'S', 'C', 'O', 'P', 'M', 'S', 'H', '\0'};
+
+		struct Header
+		{
+			char magic[8];
+			uint32_t version;
+			uint32_t vertexSize;
+
+			uint64_t sourceSize;
+			int64_t sourceModified;
+			uint64_t sourceHash;
+
+			uint64_t vertexCount;
+			uint64_t indexCount;
+			uint64_t lodCount;
+			uint64_t submeshCount;
+			uint64_t materialCount;
+			uint64_t libraryCount;
+
+			float boundsMin[3];
+			float boundsMax[3];
+			float center[3];
+			float size;
+		};
+
+		// Follows the indices of the full mesh, once per level of detail,
+		// with the indices of every level after the last entry
+		struct LodEntry
+		{
+			uint64_t indexCount;
+			float error;
+			uint32_t padding;
+		};
+
+		// After the indices of the last level: the submesh offsets of every level,
+		// one entry per submesh, then the submesh, material and library names,
+		// each prefixed by its length
+		struct SubmeshEntry
+		{
+			uint32_t firstIndex;
+			uint32_t indexCount;
+			uint32_t material;
+			float boundsMin[3];
+			float boundsMax[3];
+		};
+
+		// Well above what buildLodChain makes, only guards against corrupt headers
+		const uint64_t maximumLodCount = 64;
+
+		bool readString(const char *&cursor, const char *end, std::string &string)
+		{
+			uint32_t length;
+
+			if (end - cursor < (ptrdiff_t)sizeof(length))
+				return false;
+			std::memcpy(&length, cursor, sizeof(length));
+			cursor += sizeof(length);
+
+			if (end - cursor < (ptrdiff_t)length)
+				return false;
+			string.assign(cursor, length);
+			cursor += length;
+			return true;
+		}
+
+		// Every index has to name a vertex, meshlets and the GPU read them unchecked
+		bool indicesInRange(const unsigned int *indices, uint64_t indexCount, uint64_t vertexCount)
+		{
+			for (uint64_t i = 0; i < indexCount; i++)
+			{
+				if (indices[i] >= vertexCount)
+					return false;
+			}
+			return true;
+		}
+
+		void writeString(std::ofstream &file, const std::string &string)
+		{
+			const uint32_t length = string.size();
+			file.write(reinterpret_cast<const char *>(&length), sizeof(length));
+			file.write(string.data(), length);
+		}
+
+		// Vertex data starts on a cache line, indices follow right after it
+		const size_t dataOffset = (sizeof(Header) + 63) & ~size_t(63);
+
+		struct SourceInfo
+		{
+			uint64_t size;
+			int64_t modified;
+		};
+
+		bool statSource(const std::string &path, SourceInfo &info)
+		{
+			struct stat status;
+
+			if (stat(path.c_str(), &status) < 0)
+				return false;
+
+			info.size = status.st_size;
+			info.modified = (int64_t)status.st_mtim.tv_sec * 1000000000 + status.st_mtim.tv_nsec;
+			return true;
+		}
+
+		std::string siblingPath(const std::string &objectPath)
+		{
+			const size_t slash = objectPath.find_last_of('/');
+			const size_t dot = objectPath.find_last_of('.');
+
+			if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+				return objectPath + ".scopmesh";
+			return objectPath.substr(0, dot) + ".scopmesh";
+		}
+
+		std::string cacheDirectoryPath(const std::string &objectPath)
+		{
+			const std::string directory = FileSystem::cacheDirectory();
+
+			if (directory.empty())
+				return "";
+
+			char resolved[PATH_MAX];
+			const std::string absolute = realpath(objectPath.c_str(), resolved) ? resolved : objectPath;
+
+			char name[32];
+			std::snprintf(name, sizeof(name), "%016llx", (unsigned long long)Hash::bytes(absolute.data(), absolute.size()));
+			return directory + "/" + name + ".scopmesh";
+		}
+
+		bool loadFrom(const std::string &cachePath, const std::string &objectPath, const SourceInfo &source, Mesh &mesh)
+		{
+			FileSystem::MappedFile file;
+
+			try
+			{
+				file = FileSystem::MappedFile(cachePath);
+			}
+			catch (const std::runtime_error &)
+			{
+				return false;
+			}
+
+			if (file.size() < dataOffset)
+				return false;
+
+			Header header;
+			std::memcpy(&header, file.begin(), sizeof(Header));
+
+			if (std::memcmp(header.magic, magic, sizeof(magic)) != 0 || header.version != version ||
+				header.vertexSize != sizeof(Vertex) || header.sourceSize != source.size || header.lodCount > maximumLodCount ||
+				header.submeshCount > header.indexCount || header.materialCount > header.submeshCount ||
+				header.libraryCount > file.size() || header.vertexCount > file.size() / sizeof(Vertex) ||
+				header.indexCount > file.size() / sizeof(unsigned int))
+				return false;
+
+			const uint64_t lodOffset = dataOffset + header.vertexCount * sizeof(Vertex) + header.indexCount * sizeof(unsigned int);
+			uint64_t expectedSize = lodOffset + header.lodCount * sizeof(LodEntry);
+			if (file.size() < expectedSize)
+				return false;
+
+			std::vector<LodEntry> entries(header.lodCount);
+			std::memcpy(entries.data(), file.begin() + lodOffset, entries.size() * sizeof(LodEntry));
+			for (const LodEntry &entry : entries)
+			{
+				// Counts bounded by the file size keep the sums below from wrapping
+				if (entry.indexCount > file.size() / sizeof(unsigned int))
+					return false;
+				expectedSize += entry.indexCount * sizeof(unsigned int);
+			}
+
+			const uint64_t offsetCount = header.submeshCount ? header.lodCount * (header.submeshCount + 1) : 0;
+			const uint64_t partsOffset = expectedSize;
+			expectedSize += offsetCount * sizeof(uint32_t) + header.submeshCount * sizeof(SubmeshEntry);
+
+			// The names make the rest of the file, their size is only known once read
+			if (file.size() < expectedSize)
+				return false;
+
+			const char *cursor = file.begin() + expectedSize;
+			const char *end = file.begin() + file.size();
+			std::vector<std::string> names(header.submeshCount + header.materialCount);
+			for (std::string &name : names)
+			{
+				if (!readString(cursor, end, name))
+					return false;
+			}
+
+			std::vector<std::string> libraries(header.libraryCount);
+			for (std::string &library : libraries)
+			{
+				if (!readString(cursor, end, library))
+					return false;
+			}
+
+			if (cursor != end)
+				return false;
+
+			// Same size but touched since: only trust the cache if the content is unchanged
+			if (header.sourceModified != source.modified)
+			{
+				FileSystem::MappedFile sourceFile(objectPath);
+
+				if (Hash::bytes(sourceFile.begin(), sourceFile.size()) != header.sourceHash)
+					return false;
+
+				// Record the new time so the next launch doesn't hash again
+				int fd = open(cachePath.c_str(), O_WRONLY);
+				if (fd >= 0)
+				{
+					if (pwrite(fd, &source.modified, sizeof(source.modified), offsetof(Header, sourceModified)) < 0)
+						std::cerr << "Failed to update mesh cache: " << cachePath << std::endl;
+					close(fd);
+				}
+			}
+
+			const Vertex *vertices = reinterpret_cast<const Vertex *>(file.begin() + dataOffset);
+			const unsigned int *indices = reinterpret_cast<const unsigned int *>(vertices + header.vertexCount);
+			const unsigned int *lodIndices = reinterpret_cast<const unsigned int *>(file.begin() + lodOffset + entries.size() * sizeof(LodEntry));
+
+			if (!indicesInRange(indices, header.indexCount, header.vertexCount))
+				return false;
+			const unsigned int *lodIndex = lodIndices;
+			for (const LodEntry &entry : entries)
+			{
+				if (!indicesInRange(lodIndex, entry.indexCount, header.vertexCount))
+					return false;
+				lodIndex += entry.indexCount;
+			}
+
+			BoundingBox boundingBox;
+			boundingBox.min = Vec3(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]);
+			boundingBox.max = Vec3(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]);
+			const Vec3 center(header.center[0], header.center[1], header.center[2]);
+
+			mesh = Mesh(vertices, header.vertexCount, indices, header.indexCount, boundingBox, center, header.size);
+
+			mesh.lods.resize(entries.size());
+			for (size_t i = 0; i < entries.size(); i++)
+			{
+				mesh.lods[i].indices.assign(lodIndices, lodIndices + entries[i].indexCount);
+				mesh.lods[i].error = entries[i].error;
+				lodIndices += entries[i].indexCount;
+			}
+
+			const unsigned int *offsets = reinterpret_cast<const unsigned int *>(file.begin() + partsOffset);
+			for (MeshLod &lod : mesh.lods)
+			{
+				if (header.submeshCount)
+					lod.submeshOffsets.assign(offsets, offsets + header.submeshCount + 1);
+				offsets += lod.submeshOffsets.size();
+
+				for (size_t i = 1; i < lod.submeshOffsets.size(); i++)
+				{
+					if (lod.submeshOffsets[i] < lod.submeshOffsets[i - 1] || lod.submeshOffsets[i] > lod.indices.size())
+					{
+						mesh = Mesh();
+						return false;
+					}
+				}
+			}
+
+			const char *submeshData = file.begin() + partsOffset + offsetCount * sizeof(uint32_t);
+			mesh.submeshes.resize(header.submeshCount);
+			for (size_t i = 0; i < mesh.submeshes.size(); i++)
+			{
+				SubmeshEntry entry;
+				std::memcpy(&entry, submeshData + i * sizeof(SubmeshEntry), sizeof(SubmeshEntry));
+
+				Submesh &submesh = mesh.submeshes[i];
+				submesh = Submesh();
+				submesh.name = std::move(names[i]);
+				submesh.material = entry.material;
+				submesh.firstIndex = entry.firstIndex;
+				submesh.indexCount = entry.indexCount;
+				submesh.boundingBox.min = Vec3(entry.boundsMin[0], entry.boundsMin[1], entry.boundsMin[2]);
+				submesh.boundingBox.max = Vec3(entry.boundsMax[0], entry.boundsMax[1], entry.boundsMax[2]);
+
+				if (entry.material >= header.materialCount || (uint64_t)entry.firstIndex + entry.indexCount > header.indexCount)
+				{
+					mesh = Mesh();
+					return false;
+				}
+			}
+
+			for (size_t i = 0; i < header.materialCount; i++)
+				mesh.materials.push_back(Material(names[header.submeshCount + i]));
+			mesh.materialLibraries = std::move(libraries);
+			return true;
+		}
+
+		bool storeTo(const std::string &cachePath, const Header &header, const Mesh &mesh)
+		{
+			// Write then rename, so concurrent launches never map a partial file
+			const std::string temporaryPath = cachePath + ".tmp" + std::to_string(getpid());
+			std::ofstream file(temporaryPath, std::ios::binary | std::ios::out | std::ios::trunc);
+
+			if (!file.is_open())
+				return false;
+
+			const char padding[64] = {0};
+			file.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+			file.write(padding, dataOffset - sizeof(Header));
+			file.write(reinterpret_cast<const char *>(mesh.vertices.data()), mesh.vertices.size() * sizeof(Vertex));
+			file.write(reinterpret_cast<const char *>(mesh.indices.data()), mesh.indices.size() * sizeof(unsigned int));
+
+			for (const MeshLod &lod : mesh.lods)
+			{
+				LodEntry entry = {lod.indices.size(), lod.error, 0};
+				file.write(reinterpret_cast<const char *>(&entry), sizeof(LodEntry));
+			}
+			for (const MeshLod &lod : mesh.lods)
+				file.write(reinterpret_cast<const char *>(lod.indices.data()), lod.indices.size() * sizeof(unsigned int));
+
+			for (const MeshLod &lod : mesh.lods)
+				file.write(reinterpret_cast<const char *>(lod.submeshOffsets.data()), lod.submeshOffsets.size() * sizeof(unsigned int));
+			for (const Submesh &submesh : mesh.submeshes)
+			{
+				const BoundingBox &box = submesh.boundingBox;
+				SubmeshEntry entry = {submesh.firstIndex, submesh.indexCount, submesh.material,
+									  {box.min.x, box.min.y, box.min.z}, {box.max.x, box.max.y, box.max.z}};
+				file.write(reinterpret_cast<const char *>(&entry), sizeof(SubmeshEntry));
+			}
+			for (const Submesh &submesh : mesh.submeshes)
+				writeString(file, submesh.name);
+			for (const Material &material : mesh.materials)
+				writeString(file, material.name);
+			for (const std::string &library : mesh.materialLibraries)
+				writeString(file, library);
+			file.close();
+
+			if (!file || std::rename(temporaryPath.c_str(), cachePath.c_str()) != 0)
+			{
+				std::remove(temporaryPath.c_str());
+				return false;
+			}
+
+			return true;
+		}
+	}
+
+	bool load(const std::string &objectPath, Mesh &mesh)
+	{
+		SourceInfo source;
+
+		if (!statSource(objectPath, source))
+			return false;
+
+		if (loadFrom(siblingPath(objectPath), objectPath, source, mesh))
+			return true;
+
+		const std::string cachePath = cacheDirectoryPath(objectPath);
+		return !cachePath.empty() && loadFrom(cachePath, objectPath, source, mesh);
+	}
+
+	void store(const std::string &objectPath, const FileSystem::MappedFile &source, const Mesh &mesh)
+	{
+		SourceInfo info;
+
+		if (!statSource(objectPath, info))
+			return;
+
+		Header header;
+		std::memset(&header, 0, sizeof(Header));
+		std::memcpy(header.magic, magic, sizeof(magic));
+		header.version = version;
+		header.vertexSize = sizeof(Vertex);
+		header.sourceSize = info.size;
+		header.sourceModified = info.modified;
+		header.sourceHash = Hash::bytes(source.begin(), source.size());
+		header.vertexCount = mesh.vertices.size();
+		header.indexCount = mesh.indices.size();
+		header.lodCount = mesh.lods.size();
+		header.submeshCount = mesh.submeshes.size();
+		header.materialCount = mesh.materials.size();
+		header.libraryCount = mesh.materialLibraries.size();
+		header.boundsMin[0] = mesh.boundingBox.min.x;
+		header.boundsMin[1] = mesh.boundingBox.min.y;
+		header.boundsMin[2] = mesh.boundingBox.min.z;
+		header.boundsMax[0] = mesh.boundingBox.max.x;
+		header.boundsMax[1] = mesh.boundingBox.max.y;
+		header.boundsMax[2] = mesh.boundingBox.max.z;
+		header.center[0] = mesh.center.x;
+		header.center[1] = mesh.center.y;
+		header.center[2] = mesh.center.z;
+		header.size = mesh.size;
+
+		if (storeTo(siblingPath(objectPath), header, mesh))
+			return;
+
+		const std::string cachePath = cacheDirectoryPath(objectPath);
+		if (cachePath.empty() || !storeTo(cachePath, header, mesh))
+			std::cerr << "Failed to write mesh cache for: " << objectPath << std::endl;
+	}
+
+}
@@ -0,0 +1,105 @@
+#include "engine/Meshlets.hpp"
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+	void finishMeshlet(Meshlet &meshlet, const std::vector<Vertex> &vertices, const std::vector<unsigned int> &indices)
+	{
+		const unsigned int *first = &indices[meshlet.firstIndex];
+		const unsigned int *last = first + meshlet.indexCount;
+
+		Vec3 min(std::numeric_limits<float>::max()), max(-std::numeric_limits<float>::max());
+		for (const unsigned int *index = first; index < last; index++)
+		{
+			const Vec3 &p = vertices[*index].position;
+			min = Vec3(std::min(min.x, p.x), std::min(min.y, p.y), std::min(min.z, p.z));
+			max = Vec3(std::max(max.x, p.x), std::max(max.y, p.y), std::max(max.z, p.z));
+		}
+
+		meshlet.center = (min + max) / 2.0f;
+		meshlet.radius = 0.0f;
+		for (const unsigned int *index = first; index < last; index++)
+			meshlet.radius = std::max(meshlet.radius, (vertices[*index].position - meshlet.center).magnitude());
+	}
+}
+
+std::vector<Meshlet> buildMeshlets(const std::vector<Vertex> &vertices, const std::vector<unsigned int> &indices,
+								   std::vector<Submesh> &submeshes)
+{
+	std::vector<Meshlet> meshlets;
+	// Number of the meshlet that last took each vertex, counting from 1
+	std::vector<unsigned int> takenBy(vertices.size(), 0);
+
+	for (Submesh &submesh : submeshes)
+	{
+		submesh.firstMeshlet = meshlets.size();
+
+		Meshlet meshlet = Meshlet();
+		meshlet.firstIndex = submesh.firstIndex;
+		unsigned int vertexCount = 0;
+
+		for (size_t i = submesh.firstIndex; i + 2 < submesh.firstIndex + submesh.indexCount; i += 3)
+		{
+			const unsigned int *triangle = &indices[i];
+			unsigned int newVertices = 0;
+
+			for (int k = 0; k < 3; k++)
+			{
+				bool taken = takenBy[triangle[k]] == meshlets.size() + 1;
+				for (int j = 0; j < k; j++)
+					taken = taken || triangle[j] == triangle[k];
+				newVertices += !taken;
+			}
+
+			if (vertexCount + newVertices > meshletMaximumVertices || meshlet.indexCount / 3 >= meshletMaximumTriangles)
+			{
+				finishMeshlet(meshlet, vertices, indices);
+				meshlets.push_back(meshlet);
+
+				meshlet = Meshlet();
+				meshlet.firstIndex = i;
+				vertexCount = 0;
+			}
+
+			for (int k = 0; k < 3; k++)
+			{
+				if (takenBy[triangle[k]] != meshlets.size() + 1)
+				{
+					takenBy[triangle[k]] = meshlets.size() + 1;
+					vertexCount++;
+				}
+			}
+			meshlet.indexCount += 3;
+		}
+
+		if (meshlet.indexCount)
+		{
+			finishMeshlet(meshlet, vertices, indices);
+			meshlets.push_back(meshlet);
+		}
+
+		submesh.meshletCount = meshlets.size() - submesh.firstMeshlet;
+	}
+
+	return meshlets;
+}
+
+void cullMeshlets(const Meshlet *meshlets, size_t count, const Frustum &frustum,
+				  std::vector<GLsizei> &counts, std::vector<const void *> &offsets)
+{
+	for (const Meshlet *meshlet = meshlets; meshlet < meshlets + count; meshlet++)
+	{
+		if (!frustum.containsSphere(meshlet->center, meshlet->radius))
+			continue;
+
+		const void *offset = (const void *)(meshlet->firstIndex * sizeof(unsigned int));
+		if (!counts.empty() && (const char *)offsets.back() + counts.back() * sizeof(unsigned int) == offset)
+			counts.back() += meshlet->indexCount;
+		else
+		{
+			counts.push_back(meshlet->indexCount);
+			offsets.push_back(offset);
+		}
+	}
+}
\ No newline at end of file
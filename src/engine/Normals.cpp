@@ -0,0 +1,305 @@
+#include "engine/Normals.hpp"
+#include "maths/Vec3Array.hpp"
+#include "utils/Parallel.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+	struct Triangle
+	{
+		const Vec3 *a, *b, *c;
+	};
+
+	inline Triangle triangleAt(const ObjData &data, size_t triangle)
+	{
+		const ObjCorner *corners = &data.corners[triangle * 3];
+		return {&data.positions[corners[0].position], &data.positions[corners[1].position], &data.positions[corners[2].position]};
+	}
+
+	// Turns a face normal, given with its length and the dot products of the
+	// edges at each corner, into a unit normal and the corner angles
+	inline void finishTriangle(float length, const float dots[3], Vec3 &normal, float *angles)
+	{
+		if (length > 0.0f)
+			normal = normal / length;
+
+		for (int i = 0; i < 3; i++)
+			angles[i] = length > 0.0f ? std::atan2(length, dots[i]) : 0.0f;
+	}
+
+	// Unit face normals and corner angles of triangles [first, last), a block
+	// at a time through the Vec3Array kernels
+	void faceStage(const ObjData &data, size_t first, size_t last, Vec3 *normals, float *angles)
+	{
+		const size_t blockSize = 1024;
+		Vec3Array ab, ac, bc;
+		std::vector<float> lengths, dots[3];
+
+		for (size_t block = first; block < last; block += blockSize)
+		{
+			const size_t count = std::min(blockSize, last - block);
+
+			ab.resize(count);
+			ac.resize(count);
+			bc.resize(count);
+			for (size_t i = 0; i < count; i++)
+			{
+				const Triangle t = triangleAt(data, block + i);
+				ab.set(i, *t.b - *t.a);
+				ac.set(i, *t.c - *t.a);
+				bc.set(i, *t.c - *t.b);
+			}
+
+			// |ab x ac| is the same for every corner, only the dot products differ
+			const Vec3Array crosses = ab.cross(ac);
+			lengths.resize(count);
+			crosses.dot(crosses, lengths.data());
+			for (std::vector<float> &corner : dots)
+				corner.resize(count);
+			ab.dot(ac, dots[0].data());
+			ab.dot(bc, dots[1].data());
+			ac.dot(bc, dots[2].data());
+
+			for (size_t i = 0; i < count; i++)
+			{
+				// ba.bc, negated as a whole, has the same bits as summed from -ab
+				const float cornerDots[3] = {dots[0][i], -dots[1][i], dots[2][i]};
+				Vec3 &normal = normals[block + i - first];
+
+				normal = crosses[i];
+				finishTriangle(std::sqrt(lengths[i]), cornerDots, normal, &angles[(block + i - first) * 3]);
+			}
+		}
+	}
+
+	inline bool sameBits(const Vec3 &a, const Vec3 &b)
+	{
+		return std::memcmp(&a, &b, sizeof(Vec3)) == 0;
+	}
+
+	// Up to this many corners around a position, each corner compares its face
+	// with all of the others
+	const unsigned int exactValence = 64;
+
+	// Root of a corner's smoothing group, halving the path on the way
+	inline unsigned int findGroup(std::vector<unsigned int> &groups, unsigned int corner)
+	{
+		while (groups[corner] != corner)
+		{
+			groups[corner] = groups[groups[corner]];
+			corner = groups[corner];
+		}
+		return corner;
+	}
+
+	// Splits the count corners around a position into smoothing groups, joining
+	// the faces that share an edge through the position and bend less than the
+	// crease angle along it, so a group follows the surface around the
+	// position. Each corner's group is its lowest corner, which holds the
+	// group's normal in sums and is listed in roots.
+	void groupByEdges(const ObjData &data, const unsigned int *corners, unsigned int count,
+					  const std::vector<Vec3> &faceNormals, const std::vector<float> &angles, float creaseCosine,
+					  std::vector<unsigned int> &groups, std::vector<uint64_t> &edges, std::vector<Vec3> &sums,
+					  std::vector<unsigned int> &roots)
+	{
+		for (unsigned int k = 0; k < count; k++)
+			groups[k] = k;
+
+		// The two edges of every corner, keyed by the position at their far
+		// end, with the corner in the low bits
+		edges.clear();
+		for (unsigned int k = 0; k < count; k++)
+		{
+			const unsigned int triangle = corners[k] / 3;
+			for (unsigned int i = 0; i < 3; i++)
+			{
+				if (triangle * 3 + i != corners[k])
+					edges.push_back((uint64_t)data.corners[triangle * 3 + i].position << 32 | k);
+			}
+		}
+		std::sort(edges.begin(), edges.end());
+
+		// Runs of the same far position are the faces sharing that edge, two
+		// on a manifold mesh
+		for (size_t i = 0; i < edges.size();)
+		{
+			size_t runEnd = i + 1;
+			while (runEnd < edges.size() && edges[runEnd] >> 32 == edges[i] >> 32)
+				runEnd++;
+
+			for (size_t a = i; a < runEnd; a++)
+			{
+				for (size_t b = a + 1; b < runEnd; b++)
+				{
+					const unsigned int cornerA = (unsigned int)edges[a], cornerB = (unsigned int)edges[b];
+					if (faceNormals[corners[cornerA] / 3].dot(faceNormals[corners[cornerB] / 3]) < creaseCosine)
+						continue;
+
+					const unsigned int rootA = findGroup(groups, cornerA);
+					const unsigned int rootB = findGroup(groups, cornerB);
+					if (rootA != rootB)
+						groups[std::max(rootA, rootB)] = std::min(rootA, rootB);
+				}
+			}
+			i = runEnd;
+		}
+
+		for (unsigned int k = 0; k < count; k++)
+			sums[k] = Vec3();
+		for (unsigned int k = 0; k < count; k++)
+		{
+			groups[k] = findGroup(groups, k);
+			sums[groups[k]] += faceNormals[corners[k] / 3] * angles[corners[k]];
+		}
+
+		for (unsigned int k = 0; k < count; k++)
+		{
+			if (groups[k] != k)
+				continue;
+
+			const float length = sums[k].magnitude();
+			sums[k] = length > 0.0f ? sums[k] / length : Vec3(0.0f, 1.0f, 0.0f);
+			roots.push_back(k);
+		}
+	}
+}
+
+void generateNormals(ObjData &data, float creaseAngle)
+{
+	const size_t triangleCount = data.corners.size() / 3;
+	const size_t positionCount = data.positions.size();
+	const bool crease = creaseAngle < (float)M_PI;
+	const float creaseCosine = std::cos(creaseAngle);
+
+	std::vector<Vec3> faceNormals(triangleCount);
+	std::vector<float> angles(triangleCount * 3);
+
+	Parallel::forRange(triangleCount, 1 << 14, [&](size_t first, size_t last)
+	{
+		faceStage(data, first, last, &faceNormals[first], &angles[first * 3]);
+	});
+
+	// Corners around each position, in corner order (counting sort)
+	std::vector<unsigned int> incidentStart(positionCount + 1, 0);
+	std::vector<unsigned int> incident(triangleCount * 3);
+
+	for (size_t i = 0; i < triangleCount * 3; i++)
+		incidentStart[data.corners[i].position + 1]++;
+	for (size_t p = 0; p < positionCount; p++)
+		incidentStart[p + 1] += incidentStart[p];
+	{
+		std::vector<unsigned int> cursor(incidentStart.begin(), incidentStart.end() - 1);
+		for (size_t i = 0; i < triangleCount * 3; i++)
+			incident[cursor[data.corners[i].position]++] = i;
+	}
+
+	// Every position is owned by a single thread, so nothing is ever written
+	// concurrently. Each corner gets the angle weighted sum of the face
+	// normals around its position that are within the crease angle of its
+	// own. Past exactValence corners, comparing every pair of faces would
+	// grow with the square of the valence (cone tips, large fans), so the
+	// faces are grouped through their shared edges instead, see groupByEdges.
+	std::vector<Vec3> cornerNormals(triangleCount * 3);
+	std::vector<unsigned int> cornerSlots(triangleCount * 3);
+	std::vector<unsigned int> uniqueStart(positionCount + 1, 0);
+
+	Parallel::forRange(positionCount, 1 << 12, [&](size_t first, size_t last)
+	{
+		std::vector<unsigned int> groups, roots, slots;
+		std::vector<uint64_t> edges;
+		std::vector<Vec3> sums;
+
+		for (size_t p = first; p < last; p++)
+		{
+			const unsigned int begin = incidentStart[p];
+			const unsigned int count = incidentStart[p + 1] - begin;
+			const unsigned int *corners = &incident[begin];
+
+			// Every corner points at the one holding its normal in sums, roots
+			// lists those holders
+			groups.resize(count);
+			sums.resize(count);
+			roots.clear();
+
+			if (crease && count > exactValence)
+				groupByEdges(data, corners, count, faceNormals, angles, creaseCosine, groups, edges, sums, roots);
+			else
+			{
+				for (unsigned int k = 0; k < count; k++)
+				{
+					// Without creases every corner gets the same sum, computed once
+					groups[k] = crease ? k : 0;
+					if (groups[k] != k)
+						continue;
+
+					const Vec3 &faceNormal = faceNormals[corners[k] / 3];
+					Vec3 sum;
+
+					for (unsigned int j = 0; j < count; j++)
+					{
+						const Vec3 &other = faceNormals[corners[j] / 3];
+
+						if (!crease || faceNormal.dot(other) >= creaseCosine)
+							sum += other * angles[corners[j]];
+					}
+
+					const float length = sum.magnitude();
+					sums[k] = length > 0.0f ? sum / length : Vec3(0.0f, 1.0f, 0.0f);
+					roots.push_back(k);
+				}
+			}
+
+			// Normals with the same bits share a slot, numbered in corner order
+			if (roots.size() > 1)
+			{
+				std::sort(roots.begin(), roots.end(), [&](unsigned int a, unsigned int b)
+				{
+					const int order = std::memcmp(&sums[a], &sums[b], sizeof(Vec3));
+					return order != 0 ? order < 0 : a < b;
+				});
+				for (size_t i = 1; i < roots.size(); i++)
+				{
+					if (sameBits(sums[roots[i]], sums[roots[i - 1]]))
+						groups[roots[i]] = groups[roots[i - 1]];
+				}
+			}
+
+			slots.assign(count, count);
+			unsigned int unique = 0;
+			for (unsigned int k = 0; k < count; k++)
+			{
+				const unsigned int group = groups[groups[k]];
+				if (slots[group] == count)
+					slots[group] = unique++;
+				cornerNormals[corners[k]] = sums[group];
+				cornerSlots[corners[k]] = slots[group];
+			}
+
+			uniqueStart[p + 1] = unique;
+		}
+	});
+
+	for (size_t p = 0; p < positionCount; p++)
+		uniqueStart[p + 1] += uniqueStart[p];
+
+	data.normals.resize(uniqueStart[positionCount]);
+
+	Parallel::forRange(positionCount, 1 << 12, [&](size_t first, size_t last)
+	{
+		for (size_t p = first; p < last; p++)
+		{
+			for (unsigned int k = incidentStart[p]; k < incidentStart[p + 1]; k++)
+			{
+				const unsigned int corner = incident[k];
+				const unsigned int normal = uniqueStart[p] + cornerSlots[corner];
+
+				data.normals[normal] = cornerNormals[corner];
+				data.corners[corner].normal = normal;
+			}
+		}
+	});
+}
\ No newline at end of file
@@ -0,0 +1,292 @@
+#include "engine/ObjParser.hpp"
+#include "utils/Parallel.hpp"
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstring>
+
+namespace
+{
+	inline bool isSpace(char c)
+	{
+		return c == ' ' || c == '\t' || c == '\r';
+	}
+
+	inline const char *skipSpaces(const char *cursor, const char *end)
+	{
+		while (cursor < end && isSpace(*cursor))
+			cursor++;
+		return cursor;
+	}
+
+	inline const char *findLineEnd(const char *cursor, const char *end)
+	{
+		// glibc's memchr is vectorized, which is what makes line scanning cheap
+		const char *newline = static_cast<const char *>(std::memchr(cursor, '\n', end - cursor));
+		return newline ? newline : end;
+	}
+
+	// Missing or malformed numbers are read as 0, like `operator>>` into a zeroed value
+	inline const char *parseFloat(const char *cursor, const char *end, float &value)
+	{
+		cursor = skipSpaces(cursor, end);
+		if (cursor < end && *cursor == '+')
+			cursor++;
+
+		std::from_chars_result result = std::from_chars(cursor, end, value);
+		if (result.ec != std::errc())
+			return cursor;
+		return result.ptr;
+	}
+
+	// Below this many bytes per chunk, spawning threads costs more than it saves
+	const size_t minimumChunkSize = 1 << 20;
+
+	// Turns a 1-based (or negative, relative) OBJ index into a 0-based one
+	inline int resolveIndex(long index, size_t count, ObjData &data)
+	{
+		if (index > 0)
+			return static_cast<int>(index - 1);
+		if (index < 0)
+		{
+			data.relativeIndices = true;
+			return static_cast<int>(static_cast<long>(count) + index);
+		}
+		return -1;
+	}
+
+	inline const char *parseCorner(const char *cursor, const char *end, const ObjOffsets &offsets, ObjData &data, ObjCorner &corner)
+	{
+		long values[3] = {0, 0, 0};
+
+		for (int i = 0; i < 3 && cursor < end; i++)
+		{
+			std::from_chars_result result = std::from_chars(cursor, end, values[i]);
+			cursor = result.ptr;
+
+			if (cursor >= end || *cursor != '/')
+				break;
+			cursor++;
+		}
+
+		// Skip anything unexpected up to the next separator
+		while (cursor < end && !isSpace(*cursor))
+			cursor++;
+
+		corner.position = resolveIndex(values[0], offsets.positions + data.positions.size(), data);
+		corner.uv = resolveIndex(values[1], offsets.uvs + data.uvs.size(), data);
+		corner.normal = resolveIndex(values[2], offsets.normals + data.normals.size(), data);
+		return cursor;
+	}
+
+	void parseFace(const char *cursor, const char *end, const ObjOffsets &offsets, ObjData &data)
+	{
+		ObjCorner first, previous, current;
+		int count = 0;
+
+		for (cursor = skipSpaces(cursor, end); cursor < end; cursor = skipSpaces(cursor, end))
+		{
+			cursor = parseCorner(cursor, end, offsets, data, current);
+
+			if (count >= 2)
+			{
+				data.corners.push_back(first);
+				data.corners.push_back(previous);
+				data.corners.push_back(current);
+			}
+			else if (count == 0)
+				first = current;
+
+			previous = current;
+			count++;
+		}
+	}
+
+	// Rest of the line without surrounding spaces, for names and paths
+	inline std::string parseName(const char *cursor, const char *end)
+	{
+		cursor = skipSpaces(cursor, end);
+		while (end > cursor && isSpace(end[-1]))
+			end--;
+		return std::string(cursor, end);
+	}
+
+	// Parsed bytes shared by all chunks, published as a fraction of the file
+	struct Progress
+	{
+		std::atomic<size_t> parsed;
+		size_t total;
+		std::atomic<float> *fraction;
+
+		void advance(size_t bytes)
+		{
+			const size_t done = parsed.fetch_add(bytes) + bytes;
+			fraction->store(total ? (float)done / (float)total : 1.0f);
+		}
+	};
+
+	const size_t progressStep = 1 << 20;
+
+	ObjData parseLines(const char *begin, const char *end, const ObjOffsets &offsets, Progress *progress)
+	{
+		ObjData data;
+		const char *reported = begin;
+
+		for (const char *cursor = begin; cursor < end;)
+		{
+			const char *lineEnd = findLineEnd(cursor, end);
+			const char *keyword = skipSpaces(cursor, lineEnd);
+			const char *line = keyword;
+			cursor = lineEnd < end ? lineEnd + 1 : end;
+
+			while (line < lineEnd && !isSpace(*line))
+				line++;
+
+			const size_t length = line - keyword;
+
+			if (length == 1 && keyword[0] == 'v')
+			{
+				Vec3 position;
+				line = parseFloat(line, lineEnd, position.x);
+				line = parseFloat(line, lineEnd, position.y);
+				parseFloat(line, lineEnd, position.z);
+				data.positions.push_back(position);
+			}
+			else if (length == 2 && keyword[0] == 'v' && keyword[1] == 't')
+			{
+				Vec2 uv;
+				line = parseFloat(line, lineEnd, uv.x);
+				parseFloat(line, lineEnd, uv.y);
+				data.uvs.push_back(uv);
+			}
+			else if (length == 2 && keyword[0] == 'v' && keyword[1] == 'n')
+			{
+				Vec3 normal;
+				line = parseFloat(line, lineEnd, normal.x);
+				line = parseFloat(line, lineEnd, normal.y);
+				parseFloat(line, lineEnd, normal.z);
+				data.normals.push_back(normal);
+			}
+			else if (length == 1 && keyword[0] == 'f')
+				parseFace(line, lineEnd, offsets, data);
+			else if (length == 1 && (keyword[0] == 'o' || keyword[0] == 'g'))
+				data.groups.push_back({data.corners.size(), false, parseName(line, lineEnd)});
+			else if (length == 6 && std::memcmp(keyword, "usemtl", 6) == 0)
+				data.groups.push_back({data.corners.size(), true, parseName(line, lineEnd)});
+			else if (length == 6 && std::memcmp(keyword, "mtllib", 6) == 0)
+				data.materialLibraries.push_back(parseName(line, lineEnd));
+
+			if (progress && (size_t)(cursor - reported) >= progressStep)
+			{
+				progress->advance(cursor - reported);
+				reported = cursor;
+			}
+		}
+
+		if (progress)
+			progress->advance(end - reported);
+
+		return data;
+	}
+
+	template <typename T>
+	void appendChunks(std::vector<T> &destination, std::vector<ObjData> &chunks, std::vector<T> ObjData::*member)
+	{
+		std::vector<size_t> offsets(chunks.size() + 1, 0);
+		for (size_t i = 0; i < chunks.size(); i++)
+			offsets[i + 1] = offsets[i] + (chunks[i].*member).size();
+
+		destination.resize(offsets.back());
+
+		Parallel::forRange(chunks.size(), 1, [&](size_t first, size_t last)
+		{
+			for (size_t i = first; i < last; i++)
+			{
+				std::copy((chunks[i].*member).begin(), (chunks[i].*member).end(), destination.begin() + offsets[i]);
+				std::vector<T>().swap(chunks[i].*member);
+			}
+		});
+	}
+}
+
+ObjData parseObjRange(const char *begin, const char *end, const ObjOffsets &offsets)
+{
+	return parseLines(begin, end, offsets, nullptr);
+}
+
+ObjData parseObj(const char *begin, const char *end, const ObjOffsets &base, std::atomic<float> *fraction)
+{
+	const size_t size = end - begin;
+	const size_t chunkCount = std::max<size_t>(1, std::min<size_t>(Parallel::threadCount(), size / minimumChunkSize));
+
+	Progress state;
+	state.parsed = 0;
+	state.total = size;
+	state.fraction = fraction;
+	Progress *progress = fraction ? &state : nullptr;
+
+	if (chunkCount == 1)
+		return parseLines(begin, end, base, progress);
+
+	// Chunk boundaries, moved forward to the start of the next line
+	std::vector<const char *> bounds(chunkCount + 1, end);
+	bounds[0] = begin;
+	for (size_t i = 1; i < chunkCount; i++)
+	{
+		const char *split = std::max(begin + size * i / chunkCount, bounds[i - 1]);
+		split = findLineEnd(split, end);
+		bounds[i] = split < end ? split + 1 : end;
+	}
+
+	std::vector<ObjData> chunks(chunkCount);
+
+	Parallel::forRange(chunkCount, 1, [&](size_t first, size_t last)
+	{
+		for (size_t i = first; i < last; i++)
+			chunks[i] = parseLines(bounds[i], bounds[i + 1], i == 0 ? base : ObjOffsets(), progress);
+	});
+
+	// Prefix sums of the attribute counts give every chunk its global offsets
+	std::vector<ObjOffsets> offsets(chunkCount, base);
+	for (size_t i = 1; i < chunkCount; i++)
+	{
+		offsets[i].positions = offsets[i - 1].positions + chunks[i - 1].positions.size();
+		offsets[i].uvs = offsets[i - 1].uvs + chunks[i - 1].uvs.size();
+		offsets[i].normals = offsets[i - 1].normals + chunks[i - 1].normals.size();
+	}
+
+	// Positive indices are global already, relative ones were resolved against
+	// the chunk alone: parse those chunks again now that their offsets are known
+	Parallel::forRange(chunkCount, 1, [&](size_t first, size_t last)
+	{
+		for (size_t i = std::max<size_t>(first, 1); i < last; i++)
+		{
+			if (chunks[i].relativeIndices)
+				chunks[i] = parseObjRange(bounds[i], bounds[i + 1], offsets[i]);
+		}
+	});
+
+	ObjData data;
+	size_t cornerOffset = 0;
+	for (const ObjData &chunk : chunks)
+	{
+		data.relativeIndices = data.relativeIndices || chunk.relativeIndices;
+
+		// Statements are rare enough to be merged here, moving their corners
+		// from the start of the chunk to the start of the range
+		for (ObjGroup group : chunk.groups)
+		{
+			group.firstCorner += cornerOffset;
+			data.groups.push_back(std::move(group));
+		}
+		data.materialLibraries.insert(data.materialLibraries.end(), chunk.materialLibraries.begin(), chunk.materialLibraries.end());
+		cornerOffset += chunk.corners.size();
+	}
+
+	appendChunks(data.positions, chunks, &ObjData::positions);
+	appendChunks(data.uvs, chunks, &ObjData::uvs);
+	appendChunks(data.normals, chunks, &ObjData::normals);
+	appendChunks(data.corners, chunks, &ObjData::corners);
+
+	return data;
+}
\ No newline at end of file
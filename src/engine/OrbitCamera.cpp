@@ -1,6 +1,12 @@
 #include "engine/OrbitCamera.hpp"
+#include <limits>
 
 OrbitCamera::OrbitCamera(Vec3 target, float distance, float pitch, float yaw, Vec3 worldUp):
+	lastTarget(std::numeric_limits<float>::quiet_NaN()),
+	lastWorldUp(std::numeric_limits<float>::quiet_NaN()),
+	lastDistance(std::numeric_limits<float>::quiet_NaN()),
+	lastPitch(std::numeric_limits<float>::quiet_NaN()),
+	lastYaw(std::numeric_limits<float>::quiet_NaN()),
 	target(target),
 	distance(distance),
 	pitch(pitch),
@@ -10,9 +16,33 @@ OrbitCamera::OrbitCamera(Vec3 target, float distance, float pitch, float yaw, Ve
 	updateCamera();
 }
 
-Mat4 OrbitCamera::getViewMatrix()
+const Mat4 &OrbitCamera::getViewMatrix()
 {
-	return Mat4::lookAt(position, target, worldUp);
+	updateCamera();
+	return view.getView();
+}
+
+const Mat4 &OrbitCamera::getViewProjection()
+{
+	updateCamera();
+	return view.getViewProjection();
+}
+
+const Frustum &OrbitCamera::getFrustum()
+{
+	updateCamera();
+	return view.getFrustum();
+}
+
+unsigned long OrbitCamera::getVersion()
+{
+	updateCamera();
+	return view.getVersion();
+}
+
+void OrbitCamera::setPerspective(float fov, float aspectRatio, float near)
+{
+	view.setPerspective(fov, aspectRatio, near);
 }
 
 void OrbitCamera::processMouseInput(float xOffset, float yOffset)
@@ -66,7 +96,18 @@ void OrbitCamera::processMouseScroll(float yOffset)
 
 void OrbitCamera::updateCamera()
 {
+	if (target == lastTarget && distance == lastDistance && pitch == lastPitch && yaw == lastYaw && worldUp == lastWorldUp)
+		return;
+
+	lastTarget = target;
+	lastDistance = distance;
+	lastPitch = pitch;
+	lastYaw = yaw;
+	lastWorldUp = worldUp;
+
 	position.x = target.x + distance * cos(maths::radians(yaw)) * cos(maths::radians(pitch));
 	position.y = target.y + distance * sin(maths::radians(pitch));
 	position.z = target.z + distance * sin(maths::radians(yaw)) * cos(maths::radians(pitch));
+
+	view.setView(Mat4::lookAt(position, target, worldUp));
 }
\ No newline at end of file
@@ -1,73 +1,178 @@
 #include "engine/Shader.hpp"
+#include "engine/ShaderCache.hpp"
 #include "utils/FileSystem.hpp"
+#include <algorithm>
 #include <iostream>
 
-Shader::Shader(const std::string vertexFilePath, const std::string fragmentFilePath)
+namespace
 {
+	std::string injectDefines(const std::string &source, const std::vector<std::string> &defines)
+	{
+		if (defines.empty())
+			return source;
+
+		std::string block;
+		for (const std::string &define : defines)
+			block += "#define " + define + "\n";
+
+		// #version has to stay the first statement
+		const size_t version = source.find("#version");
+		const size_t lineEnd = version == std::string::npos ? std::string::npos : source.find('\n', version);
+		if (lineEnd == std::string::npos)
+			return block + source;
+		return source.substr(0, lineEnd + 1) + block + source.substr(lineEnd + 1);
+	}
+}
+
+Shader::Shader() : vertexShader(0), fragmentShader(0), cacheKey(0), ID(0) {}
+
+Shader::Shader(const std::string vertexFilePath, const std::string fragmentFilePath, const std::vector<std::string> &defines)
+	: Shader(start(vertexFilePath, fragmentFilePath, defines))
+{
+	finish();
+}
+
+Shader Shader::start(const std::string &vertexFilePath, const std::string &fragmentFilePath, const std::vector<std::string> &defines)
+{
+	Shader shader;
 	std::string vertexSource;
 	std::string fragmentSource;
 
 	try
 	{
-		vertexSource = FileSystem::read(vertexFilePath);
-		fragmentSource = FileSystem::read(fragmentFilePath);
+		vertexSource = injectDefines(FileSystem::read(vertexFilePath), defines);
+		fragmentSource = injectDefines(FileSystem::read(fragmentFilePath), defines);
 	}
 	catch (const std::runtime_error &e)
 	{
 		std::cerr << e.what() << std::endl;
-		return;
+		return shader;
 	}
 
+	shader.ID = glCreateProgram();
+
+	// Compiling is only needed the first time on a given driver
+	shader.cacheKey = ShaderCache::key(vertexSource, fragmentSource);
+	if (!ShaderCache::load(shader.ID, shader.cacheKey))
+		shader.compile(vertexSource, fragmentSource);
+
+	return shader;
+}
+
+void Shader::compile(const std::string &vertexSource, const std::string &fragmentSource)
+{
 	const char *vertexSourceC = vertexSource.c_str();
 	const char *fragmentSourceC = fragmentSource.c_str();
 
-	unsigned int vertexShader, fragmentShader;
-
 	// Compile vertex shader
 	vertexShader = glCreateShader(GL_VERTEX_SHADER);
 	glShaderSource(vertexShader, 1, &vertexSourceC, NULL);
 	glCompileShader(vertexShader);
 
-	int success;
-	char infoLog[512];
-	glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-
-	if (!success)
-	{
-		glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-		std::cerr << "Vertex shader compilation failed: " << infoLog << std::endl;
-	}
-
 	// Compile fragment shader
 	fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
 	glShaderSource(fragmentShader, 1, &fragmentSourceC, NULL);
 	glCompileShader(fragmentShader);
 
-	glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
+	// Link shaders, asking the driver to keep the binary for the cache.
+	// Nothing is queried yet, which would wait for the compiler.
+	glProgramParameteri(ID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	glAttachShader(ID, vertexShader);
+	glAttachShader(ID, fragmentShader);
+	glLinkProgram(ID);
+}
 
-	if (!success)
+void Shader::finish()
+{
+	if (!ID)
+		return;
+
+	if (vertexShader)
 	{
-		glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-		std::cerr << "Fragment shader compilation failed: " << infoLog << std::endl;
+		int success;
+		char infoLog[512];
+
+		glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
+		if (!success)
+		{
+			glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
+			std::cerr << "Vertex shader compilation failed: " << infoLog << std::endl;
+		}
+
+		glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
+		if (!success)
+		{
+			glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
+			std::cerr << "Fragment shader compilation failed: " << infoLog << std::endl;
+		}
+
+		glGetProgramiv(ID, GL_LINK_STATUS, &success);
+		if (!success)
+		{
+			glGetProgramInfoLog(ID, 512, NULL, infoLog);
+			std::cerr << "Shader program linking failed: " << infoLog << std::endl;
+		}
+		else
+			ShaderCache::store(ID, cacheKey);
+
+		// Cleanup
+		glDetachShader(ID, vertexShader);
+		glDetachShader(ID, fragmentShader);
+		glDeleteShader(vertexShader);
+		glDeleteShader(fragmentShader);
+		vertexShader = fragmentShader = 0;
 	}
 
-	// Link shaders
-	ID = glCreateProgram();
-	glAttachShader(ID, vertexShader);
-	glAttachShader(ID, fragmentShader);
-	glLinkProgram(ID);
+	enumerateUniforms();
+}
 
-	glGetProgramiv(ID, GL_LINK_STATUS, &success);
+void Shader::enumerateUniforms()
+{
+	int count = 0, maximumLength = 0;
+	glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+	glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maximumLength);
+
+	std::vector<char> name(std::max(maximumLength, 1));
+	uniforms.clear();
+	uniforms.reserve(count);
 
-	if (!success)
+	for (int i = 0; i < count; i++)
 	{
-		glGetProgramInfoLog(ID, 512, NULL, infoLog);
-		std::cerr << "Shader program linking failed: " << infoLog << std::endl;
+		int length = 0, size = 0;
+		GLenum type = 0;
+		glGetActiveUniform(ID, i, name.size(), &length, &size, &type, name.data());
+
+		// Members of uniform blocks have no location, they go through buffers
+		const int location = glGetUniformLocation(ID, name.data());
+		if (location < 0)
+			continue;
+
+		// Arrays are reported as their first element
+		std::string_view uniformName(name.data(), length);
+		if (uniformName.size() > 3 && uniformName.substr(uniformName.size() - 3) == "[0]")
+			uniformName.remove_suffix(3);
+
+		uniforms.push_back({std::string(uniformName), location, type});
 	}
+}
+
+const Shader::ActiveUniform *Shader::findUniform(std::string_view name, GLenum type) const
+{
+	for (const ActiveUniform &uniform : uniforms)
+	{
+		if (uniform.name != name)
+			continue;
+
+		// Samplers are set like ints, to a texture unit
+		const bool sampler = uniform.type == GL_SAMPLER_1D || uniform.type == GL_SAMPLER_2D || uniform.type == GL_SAMPLER_3D ||
+							 uniform.type == GL_SAMPLER_CUBE || uniform.type == GL_SAMPLER_2D_ARRAY;
+		if (uniform.type == type || (type == GL_INT && sampler))
+			return &uniform;
 
-	// Cleanup
-	glDeleteShader(vertexShader);
-	glDeleteShader(fragmentShader);
+		std::cerr << "Uniform " << name << " is not of the requested type" << std::endl;
+		return nullptr;
+	}
+	return nullptr;
 }
 
 void Shader::use()
@@ -75,32 +180,117 @@ void Shader::use()
 	glUseProgram(ID);
 }
 
-void Shader::setBool(const std::string name, bool value) const
+template <>
+UniformHandle<bool> Shader::uniform(std::string_view name) const
+{
+	const ActiveUniform *uniform = findUniform(name, GL_BOOL);
+	return uniform ? UniformHandle<bool>(ID, uniform->location) : UniformHandle<bool>();
+}
+
+template <>
+UniformHandle<int> Shader::uniform(std::string_view name) const
+{
+	const ActiveUniform *uniform = findUniform(name, GL_INT);
+	return uniform ? UniformHandle<int>(ID, uniform->location) : UniformHandle<int>();
+}
+
+template <>
+UniformHandle<float> Shader::uniform(std::string_view name) const
+{
+	const ActiveUniform *uniform = findUniform(name, GL_FLOAT);
+	return uniform ? UniformHandle<float>(ID, uniform->location) : UniformHandle<float>();
+}
+
+template <>
+UniformHandle<Vec2> Shader::uniform(std::string_view name) const
+{
+	const ActiveUniform *uniform = findUniform(name, GL_FLOAT_VEC2);
+	return uniform ? UniformHandle<Vec2>(ID, uniform->location) : UniformHandle<Vec2>();
+}
+
+template <>
+UniformHandle<Vec3> Shader::uniform(std::string_view name) const
+{
+	const ActiveUniform *uniform = findUniform(name, GL_FLOAT_VEC3);
+	return uniform ? UniformHandle<Vec3>(ID, uniform->location) : UniformHandle<Vec3>();
+}
+
+template <>
+UniformHandle<Mat4> Shader::uniform(std::string_view name) const
+{
+	const ActiveUniform *uniform = findUniform(name, GL_FLOAT_MAT4);
+	return uniform ? UniformHandle<Mat4>(ID, uniform->location) : UniformHandle<Mat4>();
+}
+
+// Handles go through glProgramUniform, so they work whatever program is in use
+template <>
+void UniformHandle<bool>::set(const bool &value) const
+{
+	if (valid())
+		glProgramUniform1i(program, location, (int)value);
+}
+
+template <>
+void UniformHandle<int>::set(const int &value) const
+{
+	if (valid())
+		glProgramUniform1i(program, location, value);
+}
+
+template <>
+void UniformHandle<float>::set(const float &value) const
+{
+	if (valid())
+		glProgramUniform1f(program, location, value);
+}
+
+template <>
+void UniformHandle<Vec2>::set(const Vec2 &value) const
+{
+	if (valid())
+		glProgramUniform2f(program, location, value.x, value.y);
+}
+
+template <>
+void UniformHandle<Vec3>::set(const Vec3 &value) const
+{
+	if (valid())
+		glProgramUniform3f(program, location, value.x, value.y, value.z);
+}
+
+template <>
+void UniformHandle<Mat4>::set(const Mat4 &value) const
+{
+	if (valid())
+		glProgramUniformMatrix4fv(program, location, 1, GL_FALSE, value.getElements());
+}
+
+void Shader::setBool(std::string_view name, bool value) const
 {
-	glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+	uniform<bool>(name).set(value);
 }
 
-void Shader::setInt(const std::string name, int value) const
+void Shader::setInt(std::string_view name, int value) const
 {
-	glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+	uniform<int>(name).set(value);
 }
 
-void Shader::setFloat(const std::string name, float value) const
+void Shader::setFloat(std::string_view name, float value) const
 {
-	glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+	uniform<float>(name).set(value);
 }
 
-void Shader::setVec2(const std::string name, const Vec2 &value) const
+void Shader::setVec2(std::string_view name, const Vec2 &value) const
 {
-	glUniform2f(glGetUniformLocation(ID, name.c_str()), value.x, value.y);
+	uniform<Vec2>(name).set(value);
 }
 
-void Shader::setVec3(const std::string name, const Vec3 &value) const
+void Shader::setVec3(std::string_view name, const Vec3 &value) const
 {
-	glUniform3f(glGetUniformLocation(ID, name.c_str()), value.x, value.y, value.z);
+	uniform<Vec3>(name).set(value);
 }
 
-void Shader::setMat4(const std::string name, const Mat4 &value) const
+void Shader::setMat4(std::string_view name, const Mat4 &value) const
 {
-	glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, value.getElements());
+	uniform<Mat4>(name).set(value);
 }
\ No newline at end of file
@@ -0,0 +1,140 @@
+#include "engine/ShaderCache.hpp"
+#include "utils/FileSystem.hpp"
+#include "utils/Hash.hpp"
+#include <glad/glad.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+#include <unistd.h>
+
+namespace ShaderCache
+{
+
+	namespace
+	{
+		// Bump whenever the layout below changes
+		const uint32_t version = 1;
+		const char magic[8] = {'S', 'C', 'O', 'P', 'S', 'H', 'D', '\0'};
+
+		// Followed by the binary, up to the end of the file
+		struct Header
+		{
+			char magic[8];
+			uint32_t version;
+			uint32_t binaryFormat;
+			uint64_t key;
+		};
+
+		std::string cachePath(uint64_t key)
+		{
+			const std::string directory = FileSystem::cacheDirectory();
+
+			if (directory.empty())
+				return "";
+
+			char name[32];
+			std::snprintf(name, sizeof(name), "%016llx", (unsigned long long)key);
+			return directory + "/" + name + ".scopshader";
+		}
+
+		// Some drivers expose the entry points but no binary format at all
+		bool supported()
+		{
+			int formatCount = 0;
+			glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+			return formatCount > 0;
+		}
+	}
+
+	uint64_t key(const std::string &vertexSource, const std::string &fragmentSource)
+	{
+		std::string driver;
+		for (GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION})
+		{
+			const char *value = reinterpret_cast<const char *>(glGetString(name));
+			driver += value ? value : "";
+			driver += '\n';
+		}
+
+		uint64_t hash = Hash::bytes(driver.data(), driver.size());
+		hash = Hash::bytes(vertexSource.data(), vertexSource.size(), hash);
+		return Hash::bytes(fragmentSource.data(), fragmentSource.size(), hash);
+	}
+
+	bool load(unsigned int program, uint64_t key)
+	{
+		const std::string path = cachePath(key);
+		FileSystem::MappedFile file;
+
+		if (path.empty() || !supported())
+			return false;
+
+		try
+		{
+			file = FileSystem::MappedFile(path);
+		}
+		catch (const std::runtime_error &)
+		{
+			return false;
+		}
+
+		if (file.size() <= sizeof(Header))
+			return false;
+
+		Header header;
+		std::memcpy(&header, file.begin(), sizeof(Header));
+
+		if (std::memcmp(header.magic, magic, sizeof(magic)) != 0 || header.version != version || header.key != key)
+			return false;
+
+		glProgramBinary(program, header.binaryFormat, file.begin() + sizeof(Header), file.size() - sizeof(Header));
+
+		int success = 0;
+		glGetProgramiv(program, GL_LINK_STATUS, &success);
+		return success;
+	}
+
+	void store(unsigned int program, uint64_t key)
+	{
+		const std::string path = cachePath(key);
+		int length = 0;
+
+		if (path.empty() || !supported())
+			return;
+
+		glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+		if (length <= 0)
+			return;
+
+		Header header;
+		std::memset(&header, 0, sizeof(Header));
+		std::memcpy(header.magic, magic, sizeof(magic));
+		header.version = version;
+		header.key = key;
+
+		std::vector<char> binary(length);
+		GLenum binaryFormat = 0;
+		glGetProgramBinary(program, length, &length, &binaryFormat, binary.data());
+		header.binaryFormat = binaryFormat;
+
+		// Write then rename, so concurrent launches never read a partial file
+		const std::string temporaryPath = path + ".tmp" + std::to_string(getpid());
+		std::ofstream file(temporaryPath, std::ios::binary | std::ios::out | std::ios::trunc);
+
+		if (file.is_open())
+		{
+			file.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+			file.write(binary.data(), length);
+			file.close();
+		}
+
+		if (!file || std::rename(temporaryPath.c_str(), path.c_str()) != 0)
+		{
+			std::remove(temporaryPath.c_str());
+			std::cerr << "Failed to write shader cache: " << path << std::endl;
+		}
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,83 @@
+#include "engine/ShaderVariants.hpp"
+#include <GLFW/glfw3.h>
+#include <cstring>
+
+namespace
+{
+	const char *featureNames[] = {"NORMAL_VIEW", "TEXTURED", "LIT"};
+
+	std::vector<std::string> definesOf(unsigned int features)
+	{
+		std::vector<std::string> defines;
+
+		for (unsigned int i = 0; i < sizeof(featureNames) / sizeof(*featureNames); i++)
+		{
+			if (features & (1u << i))
+				defines.push_back(featureNames[i]);
+		}
+		return defines;
+	}
+
+	// Drivers with GL_KHR_parallel_shader_compile may stick to one compiler
+	// thread until told how many they can use
+	void enableParallelCompile()
+	{
+		typedef void (*MaxShaderCompilerThreads)(GLuint count);
+		static bool done = false;
+
+		if (done)
+			return;
+		done = true;
+
+		int count = 0;
+		glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+		for (int i = 0; i < count; i++)
+		{
+			const char *name = reinterpret_cast<const char *>(glGetStringi(GL_EXTENSIONS, i));
+			if (!name || std::strcmp(name, "GL_KHR_parallel_shader_compile") != 0)
+				continue;
+
+			MaxShaderCompilerThreads setThreads = reinterpret_cast<MaxShaderCompilerThreads>(glfwGetProcAddress("glMaxShaderCompilerThreadsKHR"));
+			if (setThreads)
+				setThreads(0xFFFFFFFF);
+			return;
+		}
+	}
+}
+
+ShaderVariants::ShaderVariants(const std::string &vertexFilePath, const std::string &fragmentFilePath)
+	: vertexFilePath(vertexFilePath), fragmentFilePath(fragmentFilePath)
+{
+}
+
+void ShaderVariants::prepare(const std::vector<unsigned int> &featureSets)
+{
+	std::vector<unsigned int> started;
+
+	enableParallelCompile();
+
+	// Every program is submitted before any is waited for
+	for (unsigned int features : featureSets)
+	{
+		if (programs.count(features))
+			continue;
+
+		programs[features] = Shader::start(vertexFilePath, fragmentFilePath, definesOf(features));
+		started.push_back(features);
+	}
+
+	for (unsigned int features : started)
+		programs[features].finish();
+}
+
+Shader &ShaderVariants::get(unsigned int features)
+{
+	auto program = programs.find(features);
+
+	if (program == programs.end())
+	{
+		prepare({features});
+		program = programs.find(features);
+	}
+	return program->second;
+}
\ No newline at end of file
@@ -0,0 +1,452 @@
+#include "engine/Simplify.hpp"
+#include "utils/Parallel.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace
+{
+	// Levels are not worth their memory below this many triangles
+	const size_t minimumLodTriangles = 512;
+	const size_t maximumLodCount = 8;
+
+	// Sum of squared distances to a set of planes, weighted by triangle area
+	struct Quadric
+	{
+		float a00, a01, a02, a11, a12, a22;
+		float b0, b1, b2;
+		float c;
+		float weight;
+	};
+
+	void addPlane(Quadric &q, const Vec3 &normal, float distance, float weight)
+	{
+		q.a00 += weight * normal.x * normal.x;
+		q.a01 += weight * normal.x * normal.y;
+		q.a02 += weight * normal.x * normal.z;
+		q.a11 += weight * normal.y * normal.y;
+		q.a12 += weight * normal.y * normal.z;
+		q.a22 += weight * normal.z * normal.z;
+		q.b0 += weight * normal.x * distance;
+		q.b1 += weight * normal.y * distance;
+		q.b2 += weight * normal.z * distance;
+		q.c += weight * distance * distance;
+		q.weight += weight;
+	}
+
+	void addQuadric(Quadric &q, const Quadric &other)
+	{
+		q.a00 += other.a00;
+		q.a01 += other.a01;
+		q.a02 += other.a02;
+		q.a11 += other.a11;
+		q.a12 += other.a12;
+		q.a22 += other.a22;
+		q.b0 += other.b0;
+		q.b1 += other.b1;
+		q.b2 += other.b2;
+		q.c += other.c;
+		q.weight += other.weight;
+	}
+
+	// Mean squared distance of p to the planes of both quadrics
+	float collapseError(const Quadric &a, const Quadric &b, const Vec3 &p)
+	{
+		Quadric q = a;
+		addQuadric(q, b);
+
+		const float rx = q.a00 * p.x + q.a01 * p.y + q.a02 * p.z;
+		const float ry = q.a01 * p.x + q.a11 * p.y + q.a12 * p.z;
+		const float rz = q.a02 * p.x + q.a12 * p.y + q.a22 * p.z;
+		const float error = p.x * rx + p.y * ry + p.z * rz + 2.0f * (q.b0 * p.x + q.b1 * p.y + q.b2 * p.z) + q.c;
+
+		return q.weight > 0.0f ? std::max(error, 0.0f) / q.weight : 0.0f;
+	}
+
+	struct Collapse
+	{
+		unsigned int from, to;
+		float error;
+	};
+
+	class Simplifier
+	{
+	private:
+		const std::vector<Vertex> &vertices;
+
+		// Vertices split along attribute seams share a position, collapses
+		// happen between positions and carry all of their vertices along
+		std::vector<unsigned int> positionOf;
+		std::vector<Vec3> positions;
+		std::vector<unsigned int> wedgeOffsets, wedges;
+		std::vector<Quadric> quadrics;
+
+		std::vector<unsigned int> current;
+		// Triangle of the full mesh each current one comes from, which stay in order
+		std::vector<unsigned int> origins;
+		// Positions are normalized to the unit cube to keep the quadrics precise
+		float scale;
+		float maximumError;
+
+		// Triangles around each position, rebuilt every pass
+		std::vector<unsigned int> triangleOffsets, triangles;
+
+		void weldPositions();
+		void computeQuadrics();
+		void buildTriangleLists();
+		std::vector<char> findBorders() const;
+		bool flips(unsigned int from, unsigned int to, const std::vector<unsigned int> &collapsed) const;
+		unsigned int closestWedge(unsigned int vertex, unsigned int position) const;
+		size_t pass(size_t targetIndexCount);
+
+	public:
+		Simplifier(const std::vector<Vertex> &vertices, const std::vector<unsigned int> &indices);
+
+		// Collapses edges until at most targetIndexCount indices remain, or
+		// until nothing more can collapse
+		void simplify(size_t targetIndexCount);
+
+		const std::vector<unsigned int> &indices() const { return current; }
+		const std::vector<unsigned int> &triangleOrigins() const { return origins; }
+		// Root of the largest collapse error so far, in mesh units. That error is
+		// the area weighted mean of the squared distances to the merged planes,
+		// so this is an RMS distance to the original surface, not a bound on it.
+		float error() const { return std::sqrt(maximumError) * scale; }
+	};
+
+	Simplifier::Simplifier(const std::vector<Vertex> &vertices, const std::vector<unsigned int> &indices) : vertices(vertices),
+																											   current(indices),
+																											   origins(indices.size() / 3),
+																											   scale(1.0f),
+																											   maximumError(0.0f)
+	{
+		for (size_t t = 0; t < origins.size(); t++)
+			origins[t] = t;
+		weldPositions();
+		computeQuadrics();
+	}
+
+	void Simplifier::weldPositions()
+	{
+		std::vector<unsigned int> order(vertices.size());
+		for (size_t i = 0; i < order.size(); i++)
+			order[i] = i;
+
+		auto less = [&](unsigned int a, unsigned int b)
+		{
+			return std::memcmp(&vertices[a].position, &vertices[b].position, sizeof(Vec3)) < 0;
+		};
+		std::sort(order.begin(), order.end(), less);
+
+		positionOf.resize(vertices.size());
+		for (size_t i = 0; i < order.size(); i++)
+		{
+			if (i == 0 || less(order[i - 1], order[i]))
+				positions.push_back(vertices[order[i]].position);
+			positionOf[order[i]] = positions.size() - 1;
+		}
+
+		// Seam vertices of a position are contiguous in the sorted order
+		wedges = order;
+		wedgeOffsets.assign(positions.size() + 1, 0);
+		for (unsigned int position : positionOf)
+			wedgeOffsets[position + 1]++;
+		for (size_t p = 0; p < positions.size(); p++)
+			wedgeOffsets[p + 1] += wedgeOffsets[p];
+
+		if (positions.empty())
+			return;
+
+		Vec3 min = positions[0], max = positions[0];
+		for (const Vec3 &position : positions)
+		{
+			min = Vec3(std::min(min.x, position.x), std::min(min.y, position.y), std::min(min.z, position.z));
+			max = Vec3(std::max(max.x, position.x), std::max(max.y, position.y), std::max(max.z, position.z));
+		}
+
+		const Vec3 extent = max - min;
+		scale = std::max(extent.x, std::max(extent.y, extent.z));
+		if (scale <= 0.0f)
+			scale = 1.0f;
+
+		for (Vec3 &position : positions)
+			position = (position - min) / scale;
+	}
+
+	void Simplifier::computeQuadrics()
+	{
+		quadrics.assign(positions.size(), Quadric());
+
+		for (size_t i = 0; i + 2 < current.size(); i += 3)
+		{
+			const unsigned int a = positionOf[current[i]];
+			const unsigned int b = positionOf[current[i + 1]];
+			const unsigned int c = positionOf[current[i + 2]];
+
+			const Vec3 normal = (positions[b] - positions[a]).cross(positions[c] - positions[a]);
+			const float length = normal.magnitude();
+			if (length <= 0.0f)
+				continue;
+
+			const Vec3 unit = normal / length;
+			const float distance = -unit.dot(positions[a]);
+
+			addPlane(quadrics[a], unit, distance, length * 0.5f);
+			addPlane(quadrics[b], unit, distance, length * 0.5f);
+			addPlane(quadrics[c], unit, distance, length * 0.5f);
+		}
+	}
+
+	void Simplifier::buildTriangleLists()
+	{
+		triangleOffsets.assign(positions.size() + 1, 0);
+		triangles.resize(current.size());
+
+		for (unsigned int vertex : current)
+			triangleOffsets[positionOf[vertex] + 1]++;
+		for (size_t p = 0; p < positions.size(); p++)
+			triangleOffsets[p + 1] += triangleOffsets[p];
+
+		std::vector<unsigned int> cursors(triangleOffsets.begin(), triangleOffsets.end() - 1);
+		for (size_t i = 0; i < current.size(); i++)
+			triangles[cursors[positionOf[current[i]]]++] = i / 3;
+	}
+
+	// An edge used by a single triangle lies on a border, its ends are locked
+	// so open meshes keep their outline. The edges leaving each position are
+	// matched against the ones coming back, both sorted, whatever the valence.
+	std::vector<char> Simplifier::findBorders() const
+	{
+		std::vector<char> border(positions.size(), 0);
+
+		Parallel::forRange(positions.size(), 1 << 14, [&](size_t first, size_t last)
+		{
+			std::vector<unsigned int> outgoing, incoming;
+
+			for (size_t p = first; p < last; p++)
+			{
+				outgoing.clear();
+				incoming.clear();
+				for (unsigned int i = triangleOffsets[p]; i < triangleOffsets[p + 1]; i++)
+				{
+					const unsigned int *triangle = &current[triangles[i] * 3];
+					int k = 0;
+					while (positionOf[triangle[k]] != p)
+						k++;
+					outgoing.push_back(positionOf[triangle[(k + 1) % 3]]);
+					incoming.push_back(positionOf[triangle[(k + 2) % 3]]);
+				}
+				std::sort(outgoing.begin(), outgoing.end());
+				outgoing.erase(std::unique(outgoing.begin(), outgoing.end()), outgoing.end());
+				std::sort(incoming.begin(), incoming.end());
+
+				border[p] = !std::includes(incoming.begin(), incoming.end(), outgoing.begin(), outgoing.end());
+			}
+		});
+
+		return border;
+	}
+
+	// Whether moving from onto to turns a surrounding triangle over
+	bool Simplifier::flips(unsigned int from, unsigned int to, const std::vector<unsigned int> &collapsed) const
+	{
+		for (unsigned int i = triangleOffsets[from]; i < triangleOffsets[from + 1]; i++)
+		{
+			const unsigned int *triangle = &current[triangles[i] * 3];
+			unsigned int corners[3];
+
+			for (int k = 0; k < 3; k++)
+				corners[k] = collapsed[positionOf[triangle[k]]];
+			if (corners[0] == to || corners[1] == to || corners[2] == to)
+				continue;
+
+			int k = 0;
+			while (corners[k] != from && k < 2)
+				k++;
+			if (corners[k] != from)
+				continue;
+
+			const Vec3 &a = positions[corners[(k + 1) % 3]];
+			const Vec3 &b = positions[corners[(k + 2) % 3]];
+			const Vec3 before = (a - positions[from]).cross(b - positions[from]);
+			const Vec3 after = (a - positions[to]).cross(b - positions[to]);
+
+			if (before.dot(after) <= 0.0f)
+				return true;
+		}
+		return false;
+	}
+
+	// The vertex at position whose attributes are nearest to those of vertex
+	unsigned int Simplifier::closestWedge(unsigned int vertex, unsigned int position) const
+	{
+		unsigned int best = wedges[wedgeOffsets[position]];
+		float bestDistance = std::numeric_limits<float>::max();
+
+		for (unsigned int i = wedgeOffsets[position]; i < wedgeOffsets[position + 1]; i++)
+		{
+			const Vertex &a = vertices[vertex];
+			const Vertex &b = vertices[wedges[i]];
+			const Vec2 uv = a.texCoords - b.texCoords;
+			const Vec3 normal = a.normal - b.normal;
+			const float distance = uv.x * uv.x + uv.y * uv.y + normal.dot(normal);
+
+			if (distance < bestDistance)
+			{
+				best = wedges[i];
+				bestDistance = distance;
+			}
+		}
+		return best;
+	}
+
+	size_t Simplifier::pass(size_t targetIndexCount)
+	{
+		buildTriangleLists();
+		const std::vector<char> border = findBorders();
+		const float none = std::numeric_limits<float>::max();
+
+		// One candidate per interior edge, taken from the triangle where it
+		// runs from the lower position to the higher, in the cheaper direction
+		std::vector<Collapse> candidates(current.size());
+		Parallel::forRange(current.size() / 3, 1 << 12, [&](size_t first, size_t last)
+		{
+			for (size_t t = first; t < last; t++)
+			{
+				for (int k = 0; k < 3; k++)
+				{
+					const unsigned int a = positionOf[current[t * 3 + k]];
+					const unsigned int b = positionOf[current[t * 3 + (k + 1) % 3]];
+					Collapse &collapse = candidates[t * 3 + k];
+
+					collapse.error = none;
+					if (a >= b)
+						continue;
+
+					const float toB = border[a] ? none : collapseError(quadrics[a], quadrics[b], positions[b]);
+					const float toA = border[b] ? none : collapseError(quadrics[a], quadrics[b], positions[a]);
+
+					collapse.from = toB <= toA ? a : b;
+					collapse.to = toB <= toA ? b : a;
+					collapse.error = std::min(toA, toB);
+				}
+			}
+		});
+
+		candidates.erase(std::remove_if(candidates.begin(), candidates.end(), [&](const Collapse &collapse)
+		{
+			return collapse.error == none;
+		}), candidates.end());
+		std::sort(candidates.begin(), candidates.end(), [](const Collapse &a, const Collapse &b)
+		{
+			return a.error < b.error;
+		});
+
+		// An interior collapse removes two triangles. Collapses much worse than
+		// the one that would reach the goal wait for a later pass, where the
+		// quadrics around them have grown.
+		const size_t triangleGoal = (current.size() - targetIndexCount) / 3;
+		const size_t collapseGoal = std::max<size_t>(1, triangleGoal / 2);
+		const float errorLimit = collapseGoal < candidates.size() ? candidates[collapseGoal].error * 1.5f : none;
+
+		std::vector<unsigned int> collapsed(positions.size());
+		for (size_t p = 0; p < collapsed.size(); p++)
+			collapsed[p] = p;
+		std::vector<char> touched(positions.size(), 0);
+		size_t collapses = 0;
+
+		for (const Collapse &collapse : candidates)
+		{
+			if (collapse.error > errorLimit || collapses * 2 >= triangleGoal)
+				break;
+			if (touched[collapse.from] || touched[collapse.to] || flips(collapse.from, collapse.to, collapsed))
+				continue;
+
+			collapsed[collapse.from] = collapse.to;
+			addQuadric(quadrics[collapse.to], quadrics[collapse.from]);
+			touched[collapse.from] = touched[collapse.to] = 1;
+			maximumError = std::max(maximumError, collapse.error);
+			collapses++;
+		}
+
+		if (!collapses)
+			return 0;
+
+		// Move the corners of collapsed positions, dropping triangles that
+		// lost an edge in the process
+		size_t kept = 0;
+		for (size_t i = 0; i + 2 < current.size(); i += 3)
+		{
+			unsigned int triangle[3];
+			unsigned int corners[3];
+
+			for (int k = 0; k < 3; k++)
+			{
+				const unsigned int position = positionOf[current[i + k]];
+				corners[k] = collapsed[position];
+				triangle[k] = corners[k] == position ? current[i + k] : closestWedge(current[i + k], corners[k]);
+			}
+
+			if (corners[0] == corners[1] || corners[1] == corners[2] || corners[0] == corners[2])
+				continue;
+
+			origins[kept / 3] = origins[i / 3];
+			current[kept++] = triangle[0];
+			current[kept++] = triangle[1];
+			current[kept++] = triangle[2];
+		}
+		current.resize(kept);
+		origins.resize(kept / 3);
+
+		return collapses;
+	}
+
+	void Simplifier::simplify(size_t targetIndexCount)
+	{
+		while (current.size() > targetIndexCount && pass(targetIndexCount))
+			;
+	}
+}
+
+std::vector<MeshLod> buildLodChain(const std::vector<Vertex> &vertices, const std::vector<unsigned int> &indices,
+								   const std::vector<Submesh> &submeshes)
+{
+	std::vector<MeshLod> lods;
+
+	if (indices.size() / 3 < minimumLodTriangles * 2)
+		return lods;
+
+	Simplifier simplifier(vertices, indices);
+	size_t previousCount = indices.size();
+
+	while (lods.size() < maximumLodCount && previousCount / 6 >= minimumLodTriangles)
+	{
+		simplifier.simplify(previousCount / 6 * 3);
+
+		// Locked borders and flips can stall the collapses long before the target
+		const size_t count = simplifier.indices().size();
+		if (count > previousCount * 3 / 4)
+			break;
+
+		MeshLod lod;
+		lod.indices = simplifier.indices();
+		lod.error = simplifier.error();
+
+		// Surviving triangles kept their order, so each submesh is still a range
+		lod.submeshOffsets.assign(submeshes.size() + 1, 0);
+		size_t submesh = 0;
+		for (size_t t = 0; t < simplifier.triangleOrigins().size(); t++)
+		{
+			const size_t origin = simplifier.triangleOrigins()[t] * 3;
+			while (submesh < submeshes.size() && origin >= submeshes[submesh].firstIndex + submeshes[submesh].indexCount)
+				lod.submeshOffsets[++submesh] = t * 3;
+		}
+		while (submesh < submeshes.size())
+			lod.submeshOffsets[++submesh] = count;
+		lods.push_back(std::move(lod));
+		previousCount = count;
+	}
+
+	return lods;
+}
\ No newline at end of file
@@ -1,37 +1,73 @@
 #include "engine/Texture.hpp"
+#include <stdexcept>
 
-Texture::Texture() : id(0) {}
+Image::Image() : width(0), height(0), channels(0), pixels(nullptr, stbi_image_free) {}
 
-Texture::Texture(const std::string& path)
+Image loadImage(const std::string &path)
 {
-	int width, height, nrChannels;
-	stbi_set_flip_vertically_on_load(true);
-	unsigned char *data = stbi_load(path.c_str(), &width, &height, &nrChannels, 0);
+	Image image;
+
+	// The flip flag is per thread, images may be decoded on a loader thread
+	stbi_set_flip_vertically_on_load_thread(true);
+	image.pixels.reset(stbi_load(path.c_str(), &image.width, &image.height, &image.channels, 0));
+
+	if (!image.pixels)
+		throw std::runtime_error("Failed to load texture: " + path);
+
+	return image;
+}
 
-	if (!data)
+Texture::Texture() : id(0) {}
+
+Texture::Texture(const std::string& path) : id(0)
+{
+	try
+	{
+		*this = Texture(loadImage(path));
+	}
+	catch (const std::runtime_error &e)
 	{
-		std::cerr << "Failed to load texture: " << path << std::endl;
-		return;
+		std::cerr << e.what() << std::endl;
 	}
+}
 
+Texture::Texture(const Image& image) : id(0)
+{
 	glGenTextures(1, &id);
 	glBindTexture(GL_TEXTURE_2D, id);
-	if (nrChannels > 3)
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+	if (image.channels > 3)
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image.width, image.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image.pixels.get());
 	else
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, image.width, image.height, 0, GL_RGB, GL_UNSIGNED_BYTE, image.pixels.get());
 
 	// Parameters
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 
 	glGenerateMipmap(GL_TEXTURE_2D);
 	glBindTexture(GL_TEXTURE_2D, 0);
+}
 
-	stbi_image_free(data);
+Texture::Texture(Texture &&texture) noexcept : id(texture.id)
+{
+	texture.id = 0;
+}
+
+Texture &Texture::operator=(Texture &&texture) noexcept
+{
+	if (this != &texture)
+	{
+		if (id)
+			glDeleteTextures(1, &id);
+		id = texture.id;
+		texture.id = 0;
+	}
+	return *this;
 }
 
 Texture::~Texture()
 {
+	if (id)
+		glDeleteTextures(1, &id);
 }
 
 void Texture::bind(unsigned int slot) const
@@ -0,0 +1,55 @@
+#include "engine/UniformBuffer.hpp"
+#include <algorithm>
+
+UniformBuffer::UniformBuffer() : ID(0), size(0) {}
+
+UniformBuffer::UniformBuffer(UniformBinding binding, size_t size) : ID(0), size(size)
+{
+	glGenBuffers(1, &ID);
+	glBindBuffer(GL_UNIFORM_BUFFER, ID);
+	glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+	// Stays bound there, shaders pick it up through their layout(binding)
+	glBindBufferBase(GL_UNIFORM_BUFFER, binding, ID);
+}
+
+UniformBuffer::UniformBuffer(UniformBuffer &&buffer) noexcept : ID(buffer.ID), size(buffer.size)
+{
+	buffer.ID = 0;
+}
+
+UniformBuffer &UniformBuffer::operator=(UniformBuffer &&buffer) noexcept
+{
+	if (this != &buffer)
+	{
+		release();
+
+		ID = buffer.ID;
+		size = buffer.size;
+
+		buffer.ID = 0;
+	}
+	return *this;
+}
+
+UniformBuffer::~UniformBuffer()
+{
+	release();
+}
+
+void UniformBuffer::release()
+{
+	if (!ID)
+		return;
+
+	glDeleteBuffers(1, &ID);
+	ID = 0;
+}
+
+void UniformBuffer::update(const void *data, size_t size)
+{
+	glBindBuffer(GL_UNIFORM_BUFFER, ID);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, std::min(size, this->size), data);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
\ No newline at end of file
@@ -0,0 +1,206 @@
+#include "engine/VertexCache.hpp"
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+	// A vertex stamped with time t is still cached while fewer than
+	// vertexCacheSize misses happened since, which models a FIFO without
+	// having to store one. Clocks start past the cache size so that the zeroed
+	// stamps of untouched vertices read as evicted.
+	inline bool isCached(unsigned int stamp, unsigned int clock)
+	{
+		return clock - stamp <= vertexCacheSize;
+	}
+
+	struct Adjacency
+	{
+		// Triangles around vertex v are triangles[offsets[v]] to triangles[offsets[v + 1]]
+		std::vector<unsigned int> offsets;
+		std::vector<unsigned int> triangles;
+	};
+
+	Adjacency buildAdjacency(const std::vector<unsigned int> &indices, size_t vertexCount)
+	{
+		Adjacency adjacency;
+		adjacency.offsets.assign(vertexCount + 1, 0);
+		adjacency.triangles.resize(indices.size());
+
+		for (unsigned int index : indices)
+			adjacency.offsets[index + 1]++;
+		for (size_t v = 0; v < vertexCount; v++)
+			adjacency.offsets[v + 1] += adjacency.offsets[v];
+
+		std::vector<unsigned int> cursors(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+		for (size_t i = 0; i < indices.size(); i++)
+			adjacency.triangles[cursors[indices[i]]++] = i / 3;
+
+		return adjacency;
+	}
+
+	struct Tipsify
+	{
+		const std::vector<unsigned int> &indices;
+		Adjacency adjacency;
+		std::vector<unsigned int> liveTriangles;
+		std::vector<unsigned int> cacheStamps;
+		std::vector<unsigned int> deadEnds;
+		std::vector<unsigned int> candidates;
+		std::vector<bool> emitted;
+		unsigned int clock;
+		size_t restart;
+
+		Tipsify(const std::vector<unsigned int> &indices, size_t vertexCount) : indices(indices),
+																				 adjacency(buildAdjacency(indices, vertexCount)),
+																				 liveTriangles(vertexCount),
+																				 cacheStamps(vertexCount, 0),
+																				 emitted(indices.size() / 3, false),
+																				 clock(vertexCacheSize + 1),
+																				 restart(0)
+		{
+			for (size_t v = 0; v < vertexCount; v++)
+				liveTriangles[v] = adjacency.offsets[v + 1] - adjacency.offsets[v];
+		}
+
+		// Emits every triangle still around a vertex, remembering the vertices
+		// they touch as the candidates for the next fan
+		void emitFan(unsigned int fan, std::vector<unsigned int> &output)
+		{
+			candidates.clear();
+
+			for (unsigned int i = adjacency.offsets[fan]; i < adjacency.offsets[fan + 1]; i++)
+			{
+				const unsigned int triangle = adjacency.triangles[i];
+				if (emitted[triangle])
+					continue;
+				emitted[triangle] = true;
+
+				for (unsigned int j = 0; j < 3; j++)
+				{
+					const unsigned int vertex = indices[triangle * 3 + j];
+
+					output.push_back(vertex);
+					deadEnds.push_back(vertex);
+					candidates.push_back(vertex);
+					liveTriangles[vertex]--;
+
+					if (!isCached(cacheStamps[vertex], clock))
+						cacheStamps[vertex] = clock++;
+				}
+			}
+		}
+
+		// Picks the candidate that has been cached the longest and will still be
+		// once its own fan is emitted, or else backtracks to a recent vertex with
+		// triangles left, or else the next such vertex in input order
+		long nextFan()
+		{
+			long best = -1;
+			unsigned int bestPriority = 0;
+
+			for (unsigned int vertex : candidates)
+			{
+				if (!liveTriangles[vertex])
+					continue;
+
+				unsigned int priority = 1;
+				if (clock - cacheStamps[vertex] + 2 * liveTriangles[vertex] <= vertexCacheSize)
+					priority += clock - cacheStamps[vertex];
+
+				if (priority > bestPriority)
+				{
+					best = vertex;
+					bestPriority = priority;
+				}
+			}
+			if (best >= 0)
+				return best;
+
+			while (!deadEnds.empty())
+			{
+				const unsigned int vertex = deadEnds.back();
+				deadEnds.pop_back();
+				if (liveTriangles[vertex])
+					return vertex;
+			}
+
+			for (; restart < liveTriangles.size(); restart++)
+			{
+				if (liveTriangles[restart])
+					return restart;
+			}
+			return -1;
+		}
+	};
+}
+
+VertexCacheStats analyzeVertexCache(const std::vector<unsigned int> &indices, size_t vertexCount)
+{
+	std::vector<unsigned int> cacheStamps(vertexCount, 0);
+	unsigned int clock = vertexCacheSize + 1;
+	size_t misses = 0;
+
+	for (unsigned int index : indices)
+	{
+		if (isCached(cacheStamps[index], clock))
+			continue;
+		cacheStamps[index] = clock++;
+		misses++;
+	}
+
+	VertexCacheStats stats;
+	stats.acmr = indices.size() >= 3 ? (float)misses / (float)(indices.size() / 3) : 0.0f;
+	stats.atvr = vertexCount ? (float)misses / (float)vertexCount : 0.0f;
+	return stats;
+}
+
+void optimizeVertexCache(std::vector<unsigned int> &indices, size_t vertexCount)
+{
+	if (indices.size() < 3)
+		return;
+
+	Tipsify tipsify(indices, vertexCount);
+	std::vector<unsigned int> output;
+	output.reserve(indices.size());
+
+	for (long fan = indices[0]; fan >= 0; fan = tipsify.nextFan())
+		tipsify.emitFan(fan, output);
+
+	indices.swap(output);
+}
+
+void optimizeVertexCache(unsigned int *indices, size_t indexCount)
+{
+	std::vector<unsigned int> vertices(indices, indices + indexCount);
+	std::sort(vertices.begin(), vertices.end());
+	vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+
+	std::vector<unsigned int> local(indexCount);
+	for (size_t i = 0; i < indexCount; i++)
+		local[i] = std::lower_bound(vertices.begin(), vertices.end(), indices[i]) - vertices.begin();
+
+	optimizeVertexCache(local, vertices.size());
+
+	for (size_t i = 0; i < indexCount; i++)
+		indices[i] = vertices[local[i]];
+}
+
+std::vector<unsigned int> optimizeVertexFetch(std::vector<unsigned int> &indices, size_t vertexCount)
+{
+	const unsigned int unused = std::numeric_limits<unsigned int>::max();
+	std::vector<unsigned int> remap(vertexCount, unused);
+	std::vector<unsigned int> order;
+	order.reserve(vertexCount);
+
+	for (unsigned int &index : indices)
+	{
+		if (remap[index] == unused)
+		{
+			remap[index] = order.size();
+			order.push_back(index);
+		}
+		index = remap[index];
+	}
+
+	return order;
+}
\ No newline at end of file
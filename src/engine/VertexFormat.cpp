@@ -0,0 +1,103 @@
+#include "engine/VertexFormat.hpp"
+#include "maths/Utils.hpp"
+#include "utils/Parallel.hpp"
+#include <cstring>
+
+namespace
+{
+	inline uint16_t quantize(float value, float offset, float scale)
+	{
+		return (uint16_t)std::lround(maths::clamp((value - offset) / scale, 0.0f, 1.0f) * 65535.0f);
+	}
+
+	// 10-bit two's complement of a component in [-1, 1]
+	inline uint32_t packSnorm10(float value)
+	{
+		return (uint32_t)std::lround(maths::clamp(value, -1.0f, 1.0f) * 511.0f) & 0x3FF;
+	}
+}
+
+// Rounds to nearest even like the hardware conversions, with subnormals
+uint16_t packHalf(float value)
+{
+	uint32_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+
+	const uint32_t sign = (bits >> 16) & 0x8000;
+	const uint32_t magnitude = bits & 0x7FFFFFFF;
+
+	// Infinity and NaN, keeping NaNs quiet
+	if (magnitude >= 0x7F800000)
+		return sign | 0x7C00 | (magnitude > 0x7F800000 ? 0x200 : 0);
+	// 65520 and above round to infinity
+	if (magnitude >= 0x477FF000)
+		return sign | 0x7C00;
+
+	uint32_t half, remainder, halfway;
+
+	if (magnitude < 0x38800000)
+	{
+		// Below 2^-25 everything rounds to zero
+		if (magnitude < 0x33000000)
+			return sign;
+
+		const uint32_t shift = 126 - (magnitude >> 23);
+		const uint32_t mantissa = (magnitude & 0x7FFFFF) | 0x800000;
+
+		half = mantissa >> shift;
+		remainder = mantissa & ((1u << shift) - 1);
+		halfway = 1u << (shift - 1);
+	}
+	else
+	{
+		// Rebias the exponent from 127 to 15 and drop 13 mantissa bits
+		half = (magnitude - 0x38000000) >> 13;
+		remainder = magnitude & 0x1FFF;
+		halfway = 0x1000;
+	}
+
+	if (remainder > halfway || (remainder == halfway && (half & 1)))
+		half++;
+	return sign | half;
+}
+
+uint32_t packNormal(const Vec3 &normal)
+{
+	return packSnorm10(normal.x) | packSnorm10(normal.y) << 10 | packSnorm10(normal.z) << 20;
+}
+
+Vec3 quantizationScale(const BoundingBox &boundingBox)
+{
+	Vec3 scale = boundingBox.max - boundingBox.min;
+
+	scale.x = scale.x > 0.0f ? scale.x : 1.0f;
+	scale.y = scale.y > 0.0f ? scale.y : 1.0f;
+	scale.z = scale.z > 0.0f ? scale.z : 1.0f;
+	return scale;
+}
+
+std::vector<PackedVertex> packVertices(const std::vector<Vertex> &vertices, const BoundingBox &boundingBox)
+{
+	std::vector<PackedVertex> packed(vertices.size());
+	const Vec3 offset = boundingBox.min;
+	const Vec3 scale = quantizationScale(boundingBox);
+
+	Parallel::forRange(vertices.size(), 1 << 16, [&](size_t first, size_t last)
+	{
+		for (size_t i = first; i < last; i++)
+		{
+			const Vertex &vertex = vertices[i];
+			PackedVertex &result = packed[i];
+
+			result.position[0] = quantize(vertex.position.x, offset.x, scale.x);
+			result.position[1] = quantize(vertex.position.y, offset.y, scale.y);
+			result.position[2] = quantize(vertex.position.z, offset.z, scale.z);
+			result.padding = 0;
+			result.texCoords[0] = packHalf(vertex.texCoords.x);
+			result.texCoords[1] = packHalf(vertex.texCoords.y);
+			result.normal = packNormal(vertex.normal);
+		}
+	});
+
+	return packed;
+}
\ No newline at end of file
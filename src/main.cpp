@@ -10,11 +10,18 @@
 #include <map>
 
 #include "engine/Shader.hpp"
+#include "engine/ShaderVariants.hpp"
 #include "engine/OrbitCamera.hpp"
 #include "engine/Texture.hpp"
 #include "engine/Mesh.hpp"
+#include "engine/AssetLoader.hpp"
+#include "engine/Frustum.hpp"
+#include "engine/UniformBuffer.hpp"
 #include "maths/Mat4.hpp"
+#include "maths/Quat.hpp"
+#include "maths/Transform.hpp"
 #include "maths/Vec3.hpp"
+#include "maths/Vec3Array.hpp"
 #include "maths/Utils.hpp"
 
 #define STB_IMAGE_IMPLEMENTATION
@@ -31,35 +38,64 @@ void printInformations(void)
 	std::cout << "└╴ Renderer: " << glGetString(GL_RENDERER) << std::endl;
 }
 
-void error(const std::string &message)
+void printError(const std::string &message)
 {
 	std::cerr << "\e[101;1m ERR \e[0m " << message << std::endl;
+}
+
+void error(const std::string &message)
+{
+	printError(message);
 	exit(EXIT_FAILURE);
 }
 
-void handleWindowTitle(GLFWwindow *window)
+AssetLoader assetLoader;
+
+// Called every time through the main loop, drawn telling whether a frame was
+// rendered, so that the FPS only counts frames that were actually drawn
+void handleWindowTitle(GLFWwindow *window, bool drawn)
 {
 	static double previousTime = glfwGetTime();
+	static double previousTitleTime = 0.0;
+	static bool wasLoading = false;
 	static int frameCount = 0;
+	static double fps = 0.0;
 	double currentTime = glfwGetTime();
 	double deltaTime = currentTime - previousTime;
-	frameCount++;
+	if (drawn)
+		frameCount++;
+
+	std::string loadingPath;
+	float loadingProgress = 0.0f;
+	bool loading = assetLoader.busy(loadingPath, loadingProgress);
 
 	if (deltaTime >= 1.0)
 	{
-		double fps = frameCount / deltaTime;
-		double frameTime = 1000.0 / fps;
+		fps = frameCount / deltaTime;
+		frameCount = 0;
+		previousTime = currentTime;
+	}
+	// While loading, refresh the progress a few times per second
+	else if (!(loading || wasLoading) || currentTime - previousTitleTime < 0.1)
+		return;
 
-		std::stringstream ss;
+	double frameTime = fps > 0.0 ? 1000.0 / fps : 0.0;
 
-		ss << "scop";
-		ss << " - " << std::fixed << std::setprecision(0) << fps << " FPS";
-		ss << " - " << std::fixed << std::setprecision(2) << frameTime << " ms";
+	std::stringstream ss;
 
-		glfwSetWindowTitle(window, ss.str().c_str());
-		frameCount = 0;
-		previousTime = currentTime;
+	ss << "scop";
+	ss << " - " << std::fixed << std::setprecision(0) << fps << " FPS";
+	ss << " - " << std::fixed << std::setprecision(2) << frameTime << " ms";
+
+	if (loading)
+	{
+		ss << " - Loading " << loadingPath.substr(loadingPath.find_last_of('/') + 1);
+		ss << " " << std::fixed << std::setprecision(0) << loadingProgress * 100.0f << "%";
 	}
+
+	glfwSetWindowTitle(window, ss.str().c_str());
+	previousTitleTime = currentTime;
+	wasLoading = loading;
 }
 
 void resize(GLFWwindow *window, int *width, int *height)
@@ -72,7 +108,20 @@ std::map<int, bool> pressedKeys;
 
 bool rotateObject = true;
 bool showNormals = false;
+VertexFormat vertexFormat = VertexFormat::Full;
+// Copies of the model per side of the grid drawn with instancing, 1 draws it alone
+size_t instanceGrid = 1;
 OrbitCamera camera = OrbitCamera(Vec3(0.0f), 15.0f);
+Mesh mesh;
+// What was shown before a mesh started streaming in, put back if its load fails
+Mesh previousMesh;
+Texture texture;
+
+// Frames are only drawn when they would differ from the last one. Set by the
+// callbacks for whatever the main loop can't see changing by itself.
+bool redraw = true;
+// Keys held down, the camera keeps moving until they are all released
+int heldKeys = 0;
 
 bool isKeyPressed(GLFWwindow *window, int key)
 {
@@ -99,9 +148,36 @@ void handleKeyboardInput(GLFWwindow *window, float deltaTime)
 	if (isKeyPressed(window, GLFW_KEY_N))
 		showNormals = !showNormals;
 
+	if (isKeyPressed(window, GLFW_KEY_Q))
+	{
+		vertexFormat = vertexFormat == VertexFormat::Full ? VertexFormat::Packed : VertexFormat::Full;
+		std::cout << "Vertex format: " << (vertexFormat == VertexFormat::Full ? "full" : "packed") << std::endl;
+		mesh.setFormat(vertexFormat);
+	}
+
+	if (isKeyPressed(window, GLFW_KEY_I))
+	{
+		instanceGrid = instanceGrid >= 32 ? 1 : instanceGrid * 4;
+		std::cout << "Instances: " << instanceGrid * instanceGrid << std::endl;
+	}
+
 	camera.processKeyboardInput(window, deltaTime);
 }
 
+void handleKeyEvent(GLFWwindow *window, int key, int scancode, int action, int mods)
+{
+	(void)window;
+	(void)key;
+	(void)scancode;
+	(void)mods;
+
+	if (action == GLFW_PRESS)
+		heldKeys++;
+	else if (action == GLFW_RELEASE && heldKeys > 0)
+		heldKeys--;
+	redraw = true;
+}
+
 // Only move camera when mouse is pressed
 // Calculate the offset from start position (when pressed) to current position
 // When mouse is released, reset
@@ -137,13 +213,10 @@ void handleMouseInput(GLFWwindow *window, double xpos, double ypos)
 	camera.updateCamera();
 }
 
-Mesh mesh;
-Texture texture;
-
+// Dropped files are only queued here, they are loaded in the background
+// and picked up by handleLoadedAssets once ready
 void handleFileDrop(GLFWwindow *window, int count, const char **paths) {
 	(void) window;
-	bool alreadyLoadedObject = false;
-	bool alreadyLoadedTexture = false;
 
 	for (int i = 0; i < count; i++) {
 		std::string path = paths[i];
@@ -152,18 +225,64 @@ void handleFileDrop(GLFWwindow *window, int count, const char **paths) {
 
 		if (extension == "obj") {
 			std::cout << "Loading mesh: " << path << std::endl;
-			mesh = loadMesh(path);
-			alreadyLoadedObject = true;
+			assetLoader.request(AssetType::Mesh, path);
 			break;
 		} else if (extension == "png" || extension == "jpg" || extension == "jpeg") {
 			std::cout << "Loading texture: " << path << std::endl;
-			texture = Texture(path);
-			alreadyLoadedTexture = true;
+			assetLoader.request(AssetType::Texture, path);
+			break;
+		}
+	}
+}
+
+// Uploads whatever the loader finished since the last frame. Large meshes
+// first arrive in chunks, drawn as they come until the final mesh replaces them,
+// or until an error brings back the mesh shown before.
+// Returns whether anything changed on screen.
+bool handleLoadedAssets()
+{
+	static std::string streamingPath;
+	static bool meshShown = false;
+	AssetLoader::Asset asset;
+	bool loaded = false;
+
+	while (assetLoader.poll(asset)) {
+		loaded = true;
+		if (!asset.error.empty()) {
+			// Nothing to fall back on when the mesh given on the command line fails
+			if (asset.type == AssetType::Mesh && !meshShown)
+				error(asset.error);
+			printError(asset.error);
+			if (!streamingPath.empty() && streamingPath == asset.path) {
+				mesh = std::move(previousMesh);
+				mesh.setFormat(vertexFormat);
+				streamingPath.clear();
+			}
+			continue;
+		}
+
+		if (asset.type == AssetType::Mesh && asset.partial) {
+			if (streamingPath != asset.path) {
+				if (streamingPath.empty())
+					previousMesh = std::move(mesh);
+				mesh = Mesh();
+				streamingPath = asset.path;
+			}
+			mesh.append(asset.mesh);
+		} else if (asset.type == AssetType::Mesh) {
+			mesh = std::move(asset.mesh);
+			mesh.setFormat(vertexFormat);
+			mesh.upload();
+			previousMesh = Mesh();
+			streamingPath.clear();
+			meshShown = true;
+		} else {
+			texture = Texture(asset.image);
 			if (showNormals)
 				showNormals = false;
-			break;
 		}
 	}
+	return loaded;
 }
 
 int main(int ac, char **av)
@@ -207,19 +326,32 @@ int main(int ac, char **av)
 		return EXIT_FAILURE;
 	}
 
-	mesh = loadMesh(objectPath);
+	if (!std::ifstream(objectPath).good())
+		error("Failed to open file: " + objectPath);
+
+	assetLoader.request(AssetType::Mesh, objectPath);
 	texture = Texture(texturePath);
-	Shader shader("./src/shaders/default.vs", "./src/shaders/default.fs");
+	// Both programs the N key switches between, built together
+	ShaderVariants shaders("./src/shaders/default.vs", "./src/shaders/default.fs");
+	const unsigned int shadedFeatures = Textured | Lit;
+	shaders.prepare({shadedFeatures, NormalView});
+	shaders.get(shadedFeatures).uniform<int>("objectTexture").set(0);
+	UniformBuffer frameUniforms(FrameBinding, sizeof(FrameBlock));
+	UniformBuffer objectUniforms(ObjectBinding, sizeof(ObjectBlock));
+	UniformBuffer materialUniforms(MaterialBinding, sizeof(MaterialBlock));
 
 	if (ac < 3)
 		showNormals = true;
 
-	handleWindowTitle(window);
+	handleWindowTitle(window, false);
 	printInformations();
 
 	glEnable(GL_DEPTH_TEST);
 
 	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_NORMAL);
+	// Keys pressed and released while the loop sleeps still count as pressed
+	glfwSetInputMode(window, GLFW_STICKY_KEYS, GLFW_TRUE);
+	glfwSetKeyCallback(window, handleKeyEvent);
 	glfwSetCursorPosCallback(window, handleMouseInput);
 	glfwSetScrollCallback(window, [](GLFWwindow *window, double xoffset, double yoffset) {
 		(void)window;
@@ -227,55 +359,189 @@ int main(int ac, char **av)
 		camera.processMouseScroll(yoffset);
 	});
 	glfwSetDropCallback(window, handleFileDrop);
+	glfwSetFramebufferSizeCallback(window, [](GLFWwindow *window, int width, int height) {
+		(void)window;
+		(void)width;
+		(void)height;
+		redraw = true;
+	});
+	glfwSetWindowRefreshCallback(window, [](GLFWwindow *window) {
+		(void)window;
+		redraw = true;
+	});
+
+	// Loaded assets wake the loop up themselves, the timeout only keeps the
+	// loading progress in the title moving
+	const double loadingTimeout = 0.25;
+	float lastTime = glfwGetTime();
+	unsigned long drawnVersion = 0;
+	// Camera version the frame block was last uploaded for
+	unsigned long frameVersion = 0;
 
 	// Main Loop
 	while (!glfwWindowShouldClose(window))
 	{
-		// Calculate delta time
-		static float lastTime = 0.0f;
-		float currentTime = glfwGetTime();
-		float deltaTime = currentTime - lastTime;
-		lastTime = currentTime;
-
 		// Resize
 		int width, height;
 		resize(window, &width, &height);
+
+		// Nothing to draw into while minimized, sleep until the window changes
+		if (glfwGetWindowAttrib(window, GLFW_ICONIFIED) || width == 0 || height == 0)
+		{
+			glfwWaitEvents();
+			lastTime = glfwGetTime();
+			redraw = true;
+			continue;
+		}
 		float aspectRatio = (float)width / (float)height;
 
-		handleWindowTitle(window);
+		// Calculate delta time
+		float currentTime = glfwGetTime();
+		float deltaTime = currentTime - lastTime;
+		lastTime = currentTime;
+
 		handleKeyboardInput(window, deltaTime);
+		const bool loaded = handleLoadedAssets();
+
+		// Keep drawing while something moves, otherwise sleep until an event.
+		// The time slept is left out of the next delta time.
+		if (!(redraw || loaded || rotateObject || heldKeys > 0 || camera.getVersion() != drawnVersion))
+		{
+			handleWindowTitle(window, false);
+			std::string loadingPath;
+			float loadingProgress;
+			if (assetLoader.busy(loadingPath, loadingProgress))
+				glfwWaitEventsTimeout(loadingTimeout);
+			else
+				glfwWaitEvents();
+			lastTime = glfwGetTime();
+			continue;
+		}
+		redraw = false;
+		handleWindowTitle(window, true);
 
 		// Clear
 		glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-		shader.use();
-
-		Mat4 projection = Mat4::identity();
-		projection *= Mat4::infinitePerspective(maths::radians(45.0f), aspectRatio, 0.1f);
-
-		Mat4 model = Mat4::identity();
-		model *= Mat4::scale(Vec3(10.0f / mesh.size));
-		if (rotateObject)
-			model *= Mat4::rotation(0.2f * currentTime, Vec3(0.0f, 1.0f, 0.0f));
-		model *= Mat4::translation(mesh.center * -1.0f);
+		// Nothing to place or draw until the first mesh, or the first chunk
+		// of one, has arrived from the loader
+		if (mesh.indices.empty())
+		{
+			drawnVersion = camera.getVersion();
+			glfwSwapBuffers(window);
+			glfwPollEvents();
+			continue;
+		}
 
-		shader.setFloat("time", currentTime);
-		shader.setMat4("projection", projection.transpose());
-		shader.setMat4("view", camera.getViewMatrix().transpose());
-		shader.setMat4("model", model.transpose());
-		shader.setVec3("lightPos", lightPos);
-		shader.setVec3("viewPos", camera.position);
-		shader.setBool("showNormal", showNormals);
+		shaders.get(showNormals ? NormalView : shadedFeatures).use();
+
+		const float fov = maths::radians(45.0f);
+		camera.setPerspective(fov, aspectRatio, 0.1f);
+
+		// Centered, then spun and scaled to a size of 10 around the origin
+		const float modelScale = 10.0f / mesh.size;
+		const Quat spin = rotateObject ? Quat::axisAngle(0.2f * currentTime, Vec3(0.0f, 1.0f, 0.0f)) : Quat();
+		const Transform placement = Transform(Vec3(0.0f), spin, modelScale) * Transform(mesh.center * -1.0f);
+		const Mat4 model = placement.toMat4();
+
+		const Mat4 &viewProjection = camera.getViewProjection();
+		const Mat4 modelViewProjection = viewProjection * model;
+
+		// Everything in the frame block follows the camera, so it is only
+		// uploaded again once the camera has changed
+		if (camera.getVersion() != frameVersion)
+		{
+			FrameBlock frame;
+			frame.viewProjection = viewProjection;
+			frame.lightPosition = lightPos;
+			frame.lightPadding = 0.0f;
+			frame.viewPosition = camera.position;
+			frame.padding = 0.0f;
+			frameUniforms.update(frame);
+			frameVersion = camera.getVersion();
+		}
 
+		ObjectBlock object;
+		object.model = model;
+		object.modelViewProjection = modelViewProjection;
+		object.normalMatrix = model.normalMatrix();
+		object.positionScale = mesh.positionScale;
+		object.instanced = instanceGrid > 1;
+		object.positionOffset = mesh.positionOffset;
+		object.padding = 0.0f;
+		objectUniforms.update(object);
+
+		// The model is centered on the orbit target, pick the level of detail
+		// from how large its simplification errors would look on screen
+		const float pixelsPerUnit = height / (2.0f * std::tan(fov / 2.0f));
+
+		// Meshes still streaming in have no materials, materials without a
+		// diffuse map keep the texture given on the command line
+		MaterialBlock materialBlock;
+		materialBlock.padding = 0.0f;
+		const MaterialBinder bindMaterial = [&](const Material &material)
+		{
+			materialBlock.diffuse = material.diffuse;
+			materialUniforms.update(materialBlock);
+			if (material.textured)
+				material.diffuseTexture.bind();
+			else
+				texture.bind();
+		};
+		materialBlock.diffuse = Vec3(1.0f);
+		materialUniforms.update(materialBlock);
 		texture.bind();
-		mesh.draw();
+
+		if (instanceGrid == 1)
+		{
+			mesh.draw(modelViewProjection, mesh.selectLod(modelScale, camera.distance, pixelsPerUnit), bindMaterial);
+		}
+		else
+		{
+			// A grid of copies around the orbit target, each one fitting in a
+			// sphere of radius 5 once scaled. Copies out of view are left out
+			// and the level of detail is picked for the nearest one.
+			const Frustum &frustum = camera.getFrustum();
+			const float spacing = 12.0f;
+			Vec3Array offsets;
+			std::vector<unsigned char> visible;
+			std::vector<Transform> transforms;
+			float nearest = camera.distance;
+
+			for (size_t x = 0; x < instanceGrid; x++)
+			{
+				for (size_t z = 0; z < instanceGrid; z++)
+					offsets.append(Vec3(x - (instanceGrid - 1) / 2.0f, 0.0f, z - (instanceGrid - 1) / 2.0f) * spacing);
+			}
+			frustum.containsSpheres(offsets, 5.0f, visible);
+
+			for (size_t i = 0; i < offsets.size(); i++)
+			{
+				if (!visible[i])
+					continue;
+
+				const Vec3 offset = offsets[i];
+				transforms.push_back(Transform(offset) * placement);
+				nearest = std::min(nearest, (offset - camera.position).magnitude());
+			}
+
+			mesh.setInstances(transforms);
+			mesh.drawInstanced(mesh.selectLod(modelScale, nearest, pixelsPerUnit), bindMaterial);
+		}
+		drawnVersion = camera.getVersion();
 
 		glfwSwapBuffers(window);
 		glfwPollEvents();
 	}
 
-	// Cleanup
+	// Cleanup, GL objects have to go while the context still exists
+	mesh = Mesh();
+	previousMesh = Mesh();
+	texture = Texture();
+	frameUniforms = UniformBuffer();
+	objectUniforms = UniformBuffer();
+	materialUniforms = UniformBuffer();
 	glfwTerminate();
 	return EXIT_SUCCESS;
 }
\ No newline at end of file
@@ -1,365 +1,118 @@
 #include "maths/Mat4.hpp"
-#include <cmath>
-#include <iomanip>
-#include <string>
-#include <iostream>
 
-Mat4::Mat4()
-{
-	for (unsigned int i = 0; i < 4 * 4; i++)
-	{
-		elements[i] = 0.0f;
-	}
-}
+#ifdef MATHS_SSE
+# include <immintrin.h>
 
-Mat4::Mat4(const float diagonal)
+namespace
 {
-	for (unsigned int i = 0; i < 4 * 4; i++)
+	// Accumulates from zero in the same order as the scalar loops so that
+	// every lane rounds exactly like them
+	inline __m128 rowTimes(const float *row, const __m128 rows[4])
 	{
-		elements[i] = 0.0f;
+		__m128 sum = _mm_setzero_ps();
+		sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(row[0]), rows[0]));
+		sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(row[1]), rows[1]));
+		sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(row[2]), rows[2]));
+		sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(row[3]), rows[3]));
+		return sum;
 	}
-	elements[0 + 0 * 4] = diagonal;
-	elements[1 + 1 * 4] = diagonal;
-	elements[2 + 2 * 4] = diagonal;
-	elements[3 + 3 * 4] = diagonal;
-}
 
-Mat4::Mat4(const float elements[4 * 4])
-{
-	for (unsigned int i = 0; i < 4 * 4; i++)
+	// Columns of a row-major matrix, i.e. the rows of its transpose
+	inline void loadColumns(const float *elements, __m128 columns[4])
 	{
-		this->elements[i] = elements[i];
+		columns[0] = _mm_load_ps(elements + 0);
+		columns[1] = _mm_load_ps(elements + 4);
+		columns[2] = _mm_load_ps(elements + 8);
+		columns[3] = _mm_load_ps(elements + 12);
+		_MM_TRANSPOSE4_PS(columns[0], columns[1], columns[2], columns[3]);
 	}
-}
 
-Mat4::Mat4(const Mat4& mat)
-{
-	for (unsigned int i = 0; i < 4 * 4; i++)
+	// x * c0 + y * c1 + z * c2, then + c3 for points, summed like the scalar code
+	inline Vec3 transformOne(const __m128 columns[4], const Vec3 &vec, bool point)
 	{
-		elements[i] = mat.elements[i];
+		__m128 sum = _mm_mul_ps(columns[0], _mm_set1_ps(vec.x));
+		sum = _mm_add_ps(sum, _mm_mul_ps(columns[1], _mm_set1_ps(vec.y)));
+		sum = _mm_add_ps(sum, _mm_mul_ps(columns[2], _mm_set1_ps(vec.z)));
+		if (point)
+			sum = _mm_add_ps(sum, columns[3]);
+
+		alignas(16) float result[4];
+		_mm_store_ps(result, sum);
+		return Vec3(result[0], result[1], result[2]);
 	}
 }
 
-Mat4& Mat4::operator=(const Mat4& mat)
+namespace maths::simd
 {
-	for (unsigned int i = 0; i < 4 * 4; i++)
+	void add(const float *a, const float *b, float *result)
 	{
-		elements[i] = mat.elements[i];
+		for (unsigned int i = 0; i < 4 * 4; i += 4)
+			_mm_store_ps(result + i, _mm_add_ps(_mm_load_ps(a + i), _mm_load_ps(b + i)));
 	}
-	return *this;
-}
-
-float& Mat4::operator()(const unsigned int row, const unsigned int column)
-{
-	return elements[column + row * 4];
-}
 
-const float& Mat4::operator()(const unsigned int row, const unsigned int column) const
-{
-	return elements[column + row * 4];
-}
-
-Mat4 Mat4::operator+(const Mat4& mat) const
-{
-	Mat4 result;
-	for (unsigned int i = 0; i < 4 * 4; i++)
+	void subtract(const float *a, const float *b, float *result)
 	{
-		result.elements[i] = elements[i] + mat.elements[i];
+		for (unsigned int i = 0; i < 4 * 4; i += 4)
+			_mm_store_ps(result + i, _mm_sub_ps(_mm_load_ps(a + i), _mm_load_ps(b + i)));
 	}
-	return result;
-}
 
-Mat4 Mat4::operator-(const Mat4& mat) const
-{
-	Mat4 result;
-	for (unsigned int i = 0; i < 4 * 4; i++)
+	void multiply(const float *a, float scalar, float *result)
 	{
-		result.elements[i] = elements[i] - mat.elements[i];
+		const __m128 factor = _mm_set1_ps(scalar);
+		for (unsigned int i = 0; i < 4 * 4; i += 4)
+			_mm_store_ps(result + i, _mm_mul_ps(_mm_load_ps(a + i), factor));
 	}
-	return result;
-}
 
-Mat4 Mat4::operator*(const Mat4& mat) const
-{
-	Mat4 result;
-	for (unsigned int row = 0; row < 4; row++)
+	void multiply(const float *a, const float *b, float *result)
 	{
-		for (unsigned int column = 0; column < 4; column++)
+#if defined(__AVX__)
+		// Two rows of the result at a time, each half of the register on one
+		const __m256 rows[4] = {
+			_mm256_broadcast_ps(reinterpret_cast<const __m128 *>(b + 0)),
+			_mm256_broadcast_ps(reinterpret_cast<const __m128 *>(b + 4)),
+			_mm256_broadcast_ps(reinterpret_cast<const __m128 *>(b + 8)),
+			_mm256_broadcast_ps(reinterpret_cast<const __m128 *>(b + 12))
+		};
+		for (unsigned int row = 0; row < 4; row += 2)
 		{
-			float sum = 0.0f;
+			const float *first = a + row * 4;
+			const float *second = first + 4;
+			__m256 sum = _mm256_setzero_ps();
 			for (unsigned int i = 0; i < 4; i++)
-			{
-				sum += elements[i + row * 4] * mat.elements[column + i * 4];
-			}
-			result.elements[column + row * 4] = sum;
+				sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_set_m128(_mm_set1_ps(second[i]), _mm_set1_ps(first[i])), rows[i]));
+			_mm256_store_ps(result + row * 4, sum);
 		}
+#else
+		const __m128 rows[4] = {
+			_mm_load_ps(b + 0),
+			_mm_load_ps(b + 4),
+			_mm_load_ps(b + 8),
+			_mm_load_ps(b + 12)
+		};
+		for (unsigned int row = 0; row < 4; row++)
+			_mm_store_ps(result + row * 4, rowTimes(a + row * 4, rows));
+#endif
 	}
-	return result;
-}
 
-Mat4 Mat4::operator*(const float scalar) const
-{
-	Mat4 result;
-	for (unsigned int i = 0; i < 4 * 4; i++)
+	void transpose(const float *a, float *result)
 	{
-		result.elements[i] = elements[i] * scalar;
+		__m128 rows[4];
+		loadColumns(a, rows);
+		for (unsigned int row = 0; row < 4; row++)
+			_mm_store_ps(result + row * 4, rows[row]);
 	}
-	return result;
-}
 
-Vec3 Mat4::operator*(const Vec3& vec) const
-{
-	return Vec3(
-		elements[0 + 0 * 4] * vec.x + elements[1 + 0 * 4] * vec.y + elements[2 + 0 * 4] * vec.z + elements[3 + 0 * 4],
-		elements[0 + 1 * 4] * vec.x + elements[1 + 1 * 4] * vec.y + elements[2 + 1 * 4] * vec.z + elements[3 + 1 * 4],
-		elements[0 + 2 * 4] * vec.x + elements[1 + 2 * 4] * vec.y + elements[2 + 2 * 4] * vec.z + elements[3 + 2 * 4]
-	);
-}
-
-Mat4 Mat4::operator+=(const Mat4& mat)
-{
-	*this = *this + mat;
-	return *this;
-}
-
-Mat4 Mat4::operator-=(const Mat4& mat)
-{
-	*this = *this - mat;
-	return *this;
-}
-
-Mat4 Mat4::operator*=(const Mat4& mat)
-{
-	*this = *this * mat;
-	return *this;
-}
-
-bool Mat4::operator==(const Mat4& mat) const
-{
-	for (unsigned int i = 0; i < 4 * 4; i++)
-	{
-		if (elements[i] != mat.elements[i])
-		{
-			return false;
-		}
-	}
-	return true;
-}
-
-bool Mat4::operator!=(const Mat4& mat) const
-{
-	return !(*this == mat);
-}
-
-const float* Mat4::getElements() const
-{
-	return elements;
-}
-
-Mat4 Mat4::transpose() const
-{
-	Mat4 result;
-	for (unsigned int row = 0; row < 4; row++)
+	void transform(const float *a, const Vec3 *input, Vec3 *output, size_t count, bool point)
 	{
-		for (unsigned int column = 0; column < 4; column++)
-		{
-			result.elements[row + column * 4] = elements[column + row * 4];
-		}
+		__m128 columns[4];
+		loadColumns(a, columns);
+		for (size_t i = 0; i < count; i++)
+			output[i] = transformOne(columns, input[i], point);
 	}
-	return result;
-}
-
-Mat4 Mat4::identity()
-{
-	return Mat4(1.0f);
-}
-
-Mat4 Mat4::lookAt(const Vec3& position, const Vec3& target, const Vec3& worldUp)
-{
-	// ┌                 ┐
-	// │  rx  ry  rz -tx │
-	// │  ux  uy  uz -ty │
-	// │ -fx -fy -fz  tz │
-	// │   0   0   0   1 │
-	// └                 ┘
-	Vec3 forward = (target - position).normalize();
-	Vec3 right = forward.cross(worldUp).normalize();
-	Vec3 up = right.cross(forward).normalize();
-
-	Mat4 result(1.0f);
-	result(0, 0) = right.x;
-	result(0, 1) = right.y;
-	result(0, 2) = right.z;
-	result(0, 3) = -right.dot(position);
-
-	result(1, 0) = up.x;
-	result(1, 1) = up.y;
-	result(1, 2) = up.z;
-	result(1, 3) = -up.dot(position);
-
-	result(2, 0) = -forward.x;
-	result(2, 1) = -forward.y;
-	result(2, 2) = -forward.z;
-	result(2, 3) = forward.dot(position);
-
-	result(3, 0) = 0.0f;
-	result(3, 1) = 0.0f;
-	result(3, 2) = 0.0f;
-	result(3, 3) = 1.0f;
-
-	return result;
-}
-
-Mat4 Mat4::orthographic(const float left, const float right, const float bottom, const float top, const float near, const float far)
-{
-	Mat4 result(1.0f);
-	result(0, 0) = 2.0f / (right - left);
-	result(1, 1) = 2.0f / (top - bottom);
-	result(2, 2) = 2.0f / (near - far);
-	result(3, 0) = (left + right) / (left - right);
-	result(3, 1) = (bottom + top) / (bottom - top);
-	result(3, 2) = (far + near) / (far - near);
-	result(3, 3) = 1.0f;
-	return result;
-}
-
-Mat4 Mat4::perspective(const float fov, const float aspectRatio, const float near, const float far)
-{
-	// ┌             ┐
-	// │  a  0  0  0 │
-	// │  0  q  0  0 │
-	// │  0  0  b  c │
-	// │  0  0 -1  0 │
-	// └             ┘
-	Mat4 result(1.0f);
-	float q = 1.0f / std::tan(0.5f * fov);
-	float a = q / aspectRatio;
-	float b = (near + far) / (near - far);
-	float c = (2.0f * near * far) / (near - far);
-	result(0, 0) = a;
-	result(1, 1) = q;
-	result(2, 2) = b;
-	result(2, 3) = c;
-	result(3, 2) = -1.0f;
-	result(3, 3) = 0.0f;
-	return result;
-}
-
-Mat4 Mat4::infinitePerspective(const float fov, const float aspectRatio, const float near)
-{
-	// ┌             ┐
-	// │  a  0  0  0 │
-	// │  0  q  0  0 │
-	// │  0  0 -1 -c │
-	// │  0  0 -1  0 │
-	// └             ┘
-	Mat4 result(1.0f);
-	float q = 1.0f / std::tan(0.5f * fov);
-	float a = q / aspectRatio;
-	float c = near;
-	result(0, 0) = a;
-	result(1, 1) = q;
-	result(2, 2) = -1.0f;
-	result(2, 3) = -c;
-	result(3, 2) = -1.0f;
-	result(3, 3) = 0.0f;
-	return result;
-}
-
-Mat4 Mat4::translation(const Vec3& translation)
-{
-	// ┌             ┐
-	// │  1  0  0  x │
-	// │  0  1  0  y │
-	// │  0  0  1  z │
-	// │  0  0  0  1 │
-	// └             ┘
-	Mat4 result(1.0f);
-	result(0, 3) = translation.x;
-	result(1, 3) = translation.y;
-	result(2, 3) = translation.z;
-	return result;
 }
+#endif
 
-// https://en.wikipedia.org/wiki/Rotation_matrix#Rotation_matrix_from_axis_and_angle
-Mat4 Mat4::rotation(const float rad, const Vec3& axis)
-{
-	Mat4 result(1.0f);
-	float c = std::cos(rad);
-	float ic = 1.0f - c;
-	float s = std::sin(rad);
-	float x = axis.x;
-	float y = axis.y;
-	float z = axis.z;
-
-	result(0, 0) = c + x * x * ic;
-	result(1, 0) = y * x * ic + z * s;
-	result(2, 0) = z * x * ic - y * s;
-
-	result(0, 1) = x * y * ic - z * s;
-	result(1, 1) = c + y * y * ic;
-	result(2, 1) = z * y * ic + x * s;
-
-	result(0, 2) = x * z * ic + y * s;
-	result(1, 2) = y * z * ic - x * s;
-	result(2, 2) = c + z * z * ic;
-
-	return result;
-}
-
-Mat4 Mat4::scale(const Vec3& scale)
-{
-	// ┌             ┐
-	// │  x  0  0  0 │
-	// │  0  y  0  0 │
-	// │  0  0  z  0 │
-	// │  0  0  0  1 │
-	// └             ┘
-	Mat4 result(1.0f);
-	result(0, 0) = scale.x;
-	result(1, 1) = scale.y;
-	result(2, 2) = scale.z;
-	return result;
-}
-
-std::ostream& operator<<(std::ostream& os, const Mat4& mat)
-{
-	unsigned int largestWidth = 0;
-
-	for (unsigned int i = 0; i < 4 * 4; i++)
-	{
-		std::stringstream ss;
-		ss << std::fixed << std::setprecision(2) << mat.elements[i];
-		if (ss.str().length() > largestWidth)
-		{
-			largestWidth = ss.str().length();
-		}
-	}
-
-	os << "┌ ";
-	for (unsigned int i = 0; i < 4; i++)
-		os << std::string(largestWidth + 1, ' ');
-	os << "┐" << std::endl;
-
-	for (unsigned int row = 0; row < 4; row++)
-	{
-		os << "│ ";
-		for (unsigned int column = 0; column < 4; column++)
-		{
-			std::stringstream ss;
-			ss << std::fixed << std::setprecision(2) << mat.elements[column + row * 4];
-			std::string element = ss.str();
-			os << std::string(largestWidth - element.length(), ' ') << element;
-			if (column != 3)
-				os << " ";
-		}
-		os << " │" << std::endl;
-	}
-
-	os << "└ ";
-	for (unsigned int i = 0; i < 4; i++)
-		os << std::string(largestWidth + 1, ' ');
-	os << "┘";
-
-	return os;
-}
\ No newline at end of file
+// The factories are constant expressions
+static_assert(Mat4::translation(Vec3(1.0f, 2.0f, 3.0f)).transformPoint(Vec3(0.0f)) == Vec3(1.0f, 2.0f, 3.0f));
+static_assert(Mat4::scale(Vec3(2.0f)) * Mat4::scale(Vec3(0.5f)) == Mat4::identity());
+static_assert(Mat4::perspective(maths::radians(90.0f), 1.0f, 1.0f, 3.0f)(3, 2) == -1.0f);
\ No newline at end of file
@@ -0,0 +1,263 @@
+#include "maths/Vec3Array.hpp"
+#include <algorithm>
+
+#if defined(__SSE__)
+# include <immintrin.h>
+#endif
+
+namespace
+{
+	// The widest registers the compiler targets, the kernels below are written
+	// once against these and finish the last few elements with Vec3 code
+#if defined(__AVX__)
+# define VEC3ARRAY_LANES
+	typedef __m256 Lanes;
+	const size_t laneCount = 8;
+
+	inline Lanes load(const float *p) { return _mm256_loadu_ps(p); }
+	inline void store(float *p, Lanes v) { _mm256_storeu_ps(p, v); }
+	inline Lanes broadcast(float f) { return _mm256_set1_ps(f); }
+	inline Lanes add(Lanes a, Lanes b) { return _mm256_add_ps(a, b); }
+	inline Lanes subtract(Lanes a, Lanes b) { return _mm256_sub_ps(a, b); }
+	inline Lanes multiply(Lanes a, Lanes b) { return _mm256_mul_ps(a, b); }
+	inline Lanes divide(Lanes a, Lanes b) { return _mm256_div_ps(a, b); }
+	inline Lanes squareRoot(Lanes a) { return _mm256_sqrt_ps(a); }
+	inline Lanes minimum(Lanes a, Lanes b) { return _mm256_min_ps(a, b); }
+	inline Lanes maximum(Lanes a, Lanes b) { return _mm256_max_ps(a, b); }
+#elif defined(__SSE__)
+# define VEC3ARRAY_LANES
+	typedef __m128 Lanes;
+	const size_t laneCount = 4;
+
+	inline Lanes load(const float *p) { return _mm_loadu_ps(p); }
+	inline void store(float *p, Lanes v) { _mm_storeu_ps(p, v); }
+	inline Lanes broadcast(float f) { return _mm_set1_ps(f); }
+	inline Lanes add(Lanes a, Lanes b) { return _mm_add_ps(a, b); }
+	inline Lanes subtract(Lanes a, Lanes b) { return _mm_sub_ps(a, b); }
+	inline Lanes multiply(Lanes a, Lanes b) { return _mm_mul_ps(a, b); }
+	inline Lanes divide(Lanes a, Lanes b) { return _mm_div_ps(a, b); }
+	inline Lanes squareRoot(Lanes a) { return _mm_sqrt_ps(a); }
+	inline Lanes minimum(Lanes a, Lanes b) { return _mm_min_ps(a, b); }
+	inline Lanes maximum(Lanes a, Lanes b) { return _mm_max_ps(a, b); }
+#endif
+
+	void transform(Vec3Array &array, const Mat4 &matrix, bool point)
+	{
+		const size_t count = array.size();
+		size_t i = 0;
+
+#ifdef VEC3ARRAY_LANES
+		const float *e = matrix.getElements();
+		Lanes m[12];
+		for (int k = 0; k < 12; k++)
+			m[k] = broadcast(e[k]);
+
+		// Summed in the order of the scalar code, x then y then z then w
+		for (; i + laneCount <= count; i += laneCount)
+		{
+			const Lanes x = load(&array.x[i]), y = load(&array.y[i]), z = load(&array.z[i]);
+			Lanes rx = add(add(multiply(m[0], x), multiply(m[1], y)), multiply(m[2], z));
+			Lanes ry = add(add(multiply(m[4], x), multiply(m[5], y)), multiply(m[6], z));
+			Lanes rz = add(add(multiply(m[8], x), multiply(m[9], y)), multiply(m[10], z));
+			if (point)
+			{
+				rx = add(rx, m[3]);
+				ry = add(ry, m[7]);
+				rz = add(rz, m[11]);
+			}
+			store(&array.x[i], rx);
+			store(&array.y[i], ry);
+			store(&array.z[i], rz);
+		}
+#endif
+
+		for (; i < count; i++)
+			array.set(i, point ? matrix.transformPoint(array[i]) : matrix.transformDirection(array[i]));
+	}
+}
+
+Vec3Array::Vec3Array() {}
+
+Vec3Array::Vec3Array(size_t count) : x(count), y(count), z(count) {}
+
+Vec3Array::Vec3Array(const Vec3 *vecs, size_t count, size_t stride)
+{
+	assign(vecs, count, stride);
+}
+
+void Vec3Array::assign(const Vec3 *vecs, size_t count, size_t stride)
+{
+	const char *bytes = reinterpret_cast<const char *>(vecs);
+
+	resize(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		const Vec3 &vec = *reinterpret_cast<const Vec3 *>(bytes + i * stride);
+		x[i] = vec.x;
+		y[i] = vec.y;
+		z[i] = vec.z;
+	}
+}
+
+size_t Vec3Array::size() const
+{
+	return x.size();
+}
+
+void Vec3Array::resize(size_t count)
+{
+	x.resize(count);
+	y.resize(count);
+	z.resize(count);
+}
+
+void Vec3Array::append(const Vec3 &vec)
+{
+	x.push_back(vec.x);
+	y.push_back(vec.y);
+	z.push_back(vec.z);
+}
+
+Vec3 Vec3Array::operator[](size_t i) const
+{
+	return Vec3(x[i], y[i], z[i]);
+}
+
+void Vec3Array::set(size_t i, const Vec3 &vec)
+{
+	x[i] = vec.x;
+	y[i] = vec.y;
+	z[i] = vec.z;
+}
+
+void Vec3Array::transformPoints(const Mat4 &matrix)
+{
+	transform(*this, matrix, true);
+}
+
+void Vec3Array::transformDirections(const Mat4 &matrix)
+{
+	transform(*this, matrix, false);
+}
+
+void Vec3Array::normalize()
+{
+	const size_t count = size();
+	size_t i = 0;
+
+#ifdef VEC3ARRAY_LANES
+	for (; i + laneCount <= count; i += laneCount)
+	{
+		const Lanes vx = load(&x[i]), vy = load(&y[i]), vz = load(&z[i]);
+		const Lanes length = squareRoot(add(add(multiply(vx, vx), multiply(vy, vy)), multiply(vz, vz)));
+		store(&x[i], divide(vx, length));
+		store(&y[i], divide(vy, length));
+		store(&z[i], divide(vz, length));
+	}
+#endif
+
+	for (; i < count; i++)
+		set(i, (*this)[i].normalize());
+}
+
+void Vec3Array::dot(const Vec3 &vec, float *result) const
+{
+	const size_t count = size();
+	size_t i = 0;
+
+#ifdef VEC3ARRAY_LANES
+	const Lanes bx = broadcast(vec.x), by = broadcast(vec.y), bz = broadcast(vec.z);
+	for (; i + laneCount <= count; i += laneCount)
+		store(&result[i], add(add(multiply(load(&x[i]), bx), multiply(load(&y[i]), by)), multiply(load(&z[i]), bz)));
+#endif
+
+	for (; i < count; i++)
+		result[i] = (*this)[i].dot(vec);
+}
+
+void Vec3Array::dot(const Vec3Array &array, float *result) const
+{
+	const size_t count = size();
+	size_t i = 0;
+
+#ifdef VEC3ARRAY_LANES
+	for (; i + laneCount <= count; i += laneCount)
+	{
+		const Lanes xx = multiply(load(&x[i]), load(&array.x[i]));
+		const Lanes yy = multiply(load(&y[i]), load(&array.y[i]));
+		const Lanes zz = multiply(load(&z[i]), load(&array.z[i]));
+		store(&result[i], add(add(xx, yy), zz));
+	}
+#endif
+
+	for (; i < count; i++)
+		result[i] = (*this)[i].dot(array[i]);
+}
+
+Vec3Array Vec3Array::cross(const Vec3Array &array) const
+{
+	const size_t count = size();
+	Vec3Array result(count);
+	size_t i = 0;
+
+#ifdef VEC3ARRAY_LANES
+	for (; i + laneCount <= count; i += laneCount)
+	{
+		const Lanes ax = load(&x[i]), ay = load(&y[i]), az = load(&z[i]);
+		const Lanes bx = load(&array.x[i]), by = load(&array.y[i]), bz = load(&array.z[i]);
+		store(&result.x[i], subtract(multiply(ay, bz), multiply(az, by)));
+		store(&result.y[i], subtract(multiply(az, bx), multiply(ax, bz)));
+		store(&result.z[i], subtract(multiply(ax, by), multiply(ay, bx)));
+	}
+#endif
+
+	for (; i < count; i++)
+		result.set(i, (*this)[i].cross(array[i]));
+	return result;
+}
+
+void Vec3Array::bounds(Vec3 &min, Vec3 &max) const
+{
+	const size_t count = size();
+	size_t i = 0;
+
+#ifdef VEC3ARRAY_LANES
+	if (count >= laneCount)
+	{
+		Lanes minX = broadcast(min.x), minY = broadcast(min.y), minZ = broadcast(min.z);
+		Lanes maxX = broadcast(max.x), maxY = broadcast(max.y), maxZ = broadcast(max.z);
+
+		// New values first: like std::min and std::max, a NaN is skipped
+		for (; i + laneCount <= count; i += laneCount)
+		{
+			const Lanes vx = load(&x[i]), vy = load(&y[i]), vz = load(&z[i]);
+			minX = minimum(vx, minX);
+			minY = minimum(vy, minY);
+			minZ = minimum(vz, minZ);
+			maxX = maximum(vx, maxX);
+			maxY = maximum(vy, maxY);
+			maxZ = maximum(vz, maxZ);
+		}
+
+		float lanes[6][laneCount];
+		store(lanes[0], minX);
+		store(lanes[1], minY);
+		store(lanes[2], minZ);
+		store(lanes[3], maxX);
+		store(lanes[4], maxY);
+		store(lanes[5], maxZ);
+
+		for (size_t lane = 0; lane < laneCount; lane++)
+		{
+			min = Vec3(std::min(min.x, lanes[0][lane]), std::min(min.y, lanes[1][lane]), std::min(min.z, lanes[2][lane]));
+			max = Vec3(std::max(max.x, lanes[3][lane]), std::max(max.y, lanes[4][lane]), std::max(max.z, lanes[5][lane]));
+		}
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		min = Vec3(std::min(min.x, x[i]), std::min(min.y, y[i]), std::min(min.z, z[i]));
+		max = Vec3(std::max(max.x, x[i]), std::max(max.y, y[i]), std::max(max.z, z[i]));
+	}
+}
\ No newline at end of file
@@ -6,16 +6,39 @@ in vec3 f_position;
 in vec2 f_uv;
 in vec3 f_normal;
 
-uniform vec3 lightPos;
-uniform vec3 viewPos;
+layout (std140, row_major, binding = 0) uniform Frame
+{
+	mat4 viewProjection;
+	vec3 lightPos;
+	float lightPadding;
+	vec3 viewPos;
+	float padding;
+};
+
+layout (std140, binding = 2) uniform Material
+{
+	vec3 materialDiffuse;
+};
+
 uniform sampler2D objectTexture;
-uniform bool showNormal;
 
+// Compiled with a combination of NORMAL_VIEW, TEXTURED and LIT defined,
+// see ShaderVariants
 void main()
 {
-	if (!showNormal && texture(objectTexture, f_uv).a < 0.1)
+#ifdef NORMAL_VIEW
+	vec3 mapped_normal = f_normal * 0.5 + 0.5; // Map normal range from [-1, 1] to [0, 1]
+	FragColor = vec4(mapped_normal, 1.0);
+#else
+#ifdef TEXTURED
+	vec4 color = texture(objectTexture, f_uv);
+	if (color.a < 0.1)
 		discard;
+#else
+	vec4 color = vec4(1.0);
+#endif
 
+#ifdef LIT
 	// Light calculations
 	vec3 lightColor = vec3(1.0, 1.0, 1.0);
 
@@ -38,12 +61,10 @@ void main()
 
 	// Final light calculation
 	vec3 result = ambient + diffuse + specular;
+#else
+	vec3 result = vec3(1.0);
+#endif
 
-	vec3 mapped_normal = f_normal * 0.5 + 0.5; // Map normal range from [-1, 1] to [0, 1]
-
-	if (showNormal) {
-		FragColor = vec4(mapped_normal, 1.0);
-	} else {
-		FragColor = texture(objectTexture, f_uv) * vec4(result, 1.0);
-	}
+	FragColor = color * vec4(materialDiffuse * result, 1.0);
+#endif
 }
\ No newline at end of file
@@ -3,10 +3,29 @@
 layout (location = 0) in vec3 v_position;
 layout (location = 1) in vec2 v_uv;
 layout (location = 2) in vec3 v_normal;
+// Only read when drawing instances, replaces model
+layout (location = 3) in mat4 v_model;
 
-uniform mat4 model;
-uniform mat4 projection;
-uniform mat4 view;
+layout (std140, row_major, binding = 0) uniform Frame
+{
+	mat4 viewProjection;
+	vec3 lightPos;
+	float lightPadding;
+	vec3 viewPos;
+	float padding;
+};
+
+layout (std140, row_major, binding = 1) uniform Object
+{
+	mat4 model;
+	mat4 modelViewProjection;
+	// Inverse transpose of the model's upper 3x3, computed on the CPU
+	mat3 normalMatrix;
+	// Dequantizes packed positions, identity for full precision meshes
+	vec3 positionScale;
+	bool instanced;
+	vec3 positionOffset;
+};
 
 out vec3 f_position;
 out vec2 f_uv;
@@ -14,8 +33,21 @@ out vec3 f_normal;
 
 void main()
 {
-	f_position = vec3(model * vec4(v_position, 1.0));
-	gl_Position = projection * view * vec4(f_position, 1.0);
+	vec4 position = vec4(v_position * positionScale + positionOffset, 1.0);
+
+	if (instanced)
+	{
+		// Instances only scale uniformly, their upper 3x3 is the normal
+		// matrix up to a length
+		f_position = vec3(v_model * position);
+		gl_Position = viewProjection * vec4(f_position, 1.0);
+		f_normal = normalize(mat3(v_model) * v_normal);
+	}
+	else
+	{
+		f_position = vec3(model * position);
+		gl_Position = modelViewProjection * position;
+		f_normal = normalize(normalMatrix * v_normal);
+	}
 	f_uv = v_uv;
-	f_normal = normalize(mat3(transpose(inverse(model))) * v_normal);
 }
\ No newline at end of file
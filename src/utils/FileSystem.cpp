@@ -1,4 +1,11 @@
 #include "utils/FileSystem.hpp"
+#include <stdexcept>
+#include <cstdlib>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 namespace FileSystem
 {
@@ -19,4 +26,117 @@ namespace FileSystem
 		return content;
 	}
 
-}
\ No newline at end of file
+	namespace
+	{
+		bool makeDirectory(const std::string &path)
+		{
+			return mkdir(path.c_str(), 0755) == 0 || errno == EEXIST;
+		}
+	}
+
+	std::string cacheDirectory()
+	{
+		static const std::string directory = []() -> std::string
+		{
+			std::string base;
+			const char *xdgCache = std::getenv("XDG_CACHE_HOME");
+			const char *home = std::getenv("HOME");
+
+			if (xdgCache && *xdgCache)
+				base = xdgCache;
+			else if (home && *home)
+			{
+				base = std::string(home) + "/.cache";
+				if (!makeDirectory(base))
+					return "";
+			}
+			else
+				return "";
+
+			if (!makeDirectory(base + "/scop"))
+				return "";
+			return base + "/scop";
+		}();
+
+		return directory;
+	}
+
+	MappedFile::MappedFile() : data(nullptr), length(0) {}
+
+	MappedFile::MappedFile(const std::string &path) : data(nullptr), length(0)
+	{
+		int fd = open(path.c_str(), O_RDONLY);
+
+		if (fd < 0)
+			throw std::runtime_error("Failed to open file: " + path);
+
+		struct stat info;
+		if (fstat(fd, &info) < 0)
+		{
+			close(fd);
+			throw std::runtime_error("Failed to stat file: " + path);
+		}
+
+		length = info.st_size;
+
+		// mmap refuses zero-length mappings, an empty file is simply an empty range
+		if (length > 0)
+		{
+			void *mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+
+			if (mapping == MAP_FAILED)
+			{
+				close(fd);
+				throw std::runtime_error("Failed to map file: " + path);
+			}
+
+			madvise(mapping, length, MADV_SEQUENTIAL);
+			data = static_cast<const char *>(mapping);
+		}
+
+		close(fd);
+	}
+
+	MappedFile::MappedFile(MappedFile &&other) noexcept : data(other.data), length(other.length)
+	{
+		other.data = nullptr;
+		other.length = 0;
+	}
+
+	MappedFile &MappedFile::operator=(MappedFile &&other) noexcept
+	{
+		if (this != &other)
+		{
+			if (data)
+				munmap(const_cast<char *>(data), length);
+
+			data = other.data;
+			length = other.length;
+			other.data = nullptr;
+			other.length = 0;
+		}
+		return *this;
+	}
+
+	MappedFile::~MappedFile()
+	{
+		if (data)
+			munmap(const_cast<char *>(data), length);
+	}
+
+	const char *MappedFile::begin() const
+	{
+		return data;
+	}
+
+	const char *MappedFile::end() const
+	{
+		return data + length;
+	}
+
+	size_t MappedFile::size() const
+	{
+		return length;
+	}
+
+}
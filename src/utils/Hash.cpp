@@ -0,0 +1,96 @@
+#include "utils/Hash.hpp"
+#include <cstring>
+
+namespace Hash
+{
+
+	namespace
+	{
+		const uint64_t prime1 = 0x9E3779B185EBCA87ull;
+		const uint64_t prime2 = 0xC2B2AE3D27D4EB4Full;
+		const uint64_t prime3 = 0x165667B19E3779F9ull;
+		const uint64_t prime4 = 0x85EBCA77C2B2AE63ull;
+		const uint64_t prime5 = 0x27D4EB2F165667C5ull;
+
+		inline uint64_t rotate(uint64_t value, int bits)
+		{
+			return (value << bits) | (value >> (64 - bits));
+		}
+
+		inline uint64_t read64(const unsigned char *data)
+		{
+			uint64_t value;
+			std::memcpy(&value, data, sizeof(value));
+			return value;
+		}
+
+		inline uint32_t read32(const unsigned char *data)
+		{
+			uint32_t value;
+			std::memcpy(&value, data, sizeof(value));
+			return value;
+		}
+
+		inline uint64_t round(uint64_t accumulator, uint64_t input)
+		{
+			accumulator += input * prime2;
+			accumulator = rotate(accumulator, 31);
+			return accumulator * prime1;
+		}
+
+		inline uint64_t merge(uint64_t hash, uint64_t accumulator)
+		{
+			hash ^= round(0, accumulator);
+			return hash * prime1 + prime4;
+		}
+	}
+
+	uint64_t bytes(const void *data, size_t size, uint64_t seed)
+	{
+		const unsigned char *cursor = static_cast<const unsigned char *>(data);
+		const unsigned char *end = cursor + size;
+		uint64_t hash;
+
+		if (size >= 32)
+		{
+			uint64_t lanes[4] = {seed + prime1 + prime2, seed + prime2, seed, seed - prime1};
+
+			// Four independent lanes keep the multipliers busy
+			for (; end - cursor >= 32; cursor += 32)
+			{
+				lanes[0] = round(lanes[0], read64(cursor));
+				lanes[1] = round(lanes[1], read64(cursor + 8));
+				lanes[2] = round(lanes[2], read64(cursor + 16));
+				lanes[3] = round(lanes[3], read64(cursor + 24));
+			}
+
+			hash = rotate(lanes[0], 1) + rotate(lanes[1], 7) + rotate(lanes[2], 12) + rotate(lanes[3], 18);
+			for (uint64_t lane : lanes)
+				hash = merge(hash, lane);
+		}
+		else
+			hash = seed + prime5;
+
+		hash += size;
+
+		for (; end - cursor >= 8; cursor += 8)
+			hash = rotate(hash ^ round(0, read64(cursor)), 27) * prime1 + prime4;
+
+		if (end - cursor >= 4)
+		{
+			hash = rotate(hash ^ (read32(cursor) * prime1), 23) * prime2 + prime3;
+			cursor += 4;
+		}
+
+		for (; cursor < end; cursor++)
+			hash = rotate(hash ^ (*cursor * prime5), 11) * prime1;
+
+		hash ^= hash >> 33;
+		hash *= prime2;
+		hash ^= hash >> 29;
+		hash *= prime3;
+		hash ^= hash >> 32;
+		return hash;
+	}
+
+}
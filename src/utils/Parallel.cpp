@@ -0,0 +1,62 @@
+#include "utils/Parallel.hpp"
+#include <algorithm>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Parallel
+{
+
+	unsigned int threadCount()
+	{
+		static const unsigned int count = std::max(1u, std::thread::hardware_concurrency());
+		return count;
+	}
+
+	void forRange(size_t count, size_t minimumSlice, const std::function<void(size_t, size_t)> &function)
+	{
+		if (count == 0)
+			return;
+
+		const size_t maximumSlices = std::max<size_t>(1, count / std::max<size_t>(1, minimumSlice));
+		const size_t sliceCount = std::min<size_t>(threadCount(), maximumSlices);
+
+		if (sliceCount == 1)
+		{
+			function(0, count);
+			return;
+		}
+
+		std::vector<std::thread> threads;
+		std::exception_ptr error;
+		std::mutex errorMutex;
+
+		auto runSlice = [&](size_t slice)
+		{
+			try
+			{
+				function(count * slice / sliceCount, count * (slice + 1) / sliceCount);
+			}
+			catch (...)
+			{
+				std::lock_guard<std::mutex> lock(errorMutex);
+				if (!error)
+					error = std::current_exception();
+			}
+		};
+
+		threads.reserve(sliceCount - 1);
+		for (size_t slice = 1; slice < sliceCount; slice++)
+			threads.emplace_back(runSlice, slice);
+
+		runSlice(0);
+
+		for (std::thread &thread : threads)
+			thread.join();
+
+		if (error)
+			std::rethrow_exception(error);
+	}
+
+}
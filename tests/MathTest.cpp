@@ -0,0 +1,300 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "maths/Mat4.hpp"
+#include "maths/Vec3.hpp"
+#include "maths/Vec3Array.hpp"
+
+// Checks that the Mat4 operations, SSE and AVX kernels included, give the
+// same bits as the scalar loops they replaced, and the Vec3Array kernels the
+// same bits as the Vec3 and Mat4 operations, run with `make test-math`.
+// Rebuild with other flags (e.g. CXXFLAGS+=-mavx2) to check the other kernels.
+// Inputs include zeros, -0, denormals and infinities; NaNs only have to be
+// NaN on both sides, their payloads are not compared.
+
+namespace
+{
+	const int caseCount = 200000;
+	// Vectors per batch, not a multiple of the SIMD width so Vec3Array also
+	// finishes the last few elements with its scalar code
+	const size_t batchSize = 13;
+
+	// The loops Mat4 used before it was vectorized, summing from zero in
+	// row, column, then i order with separate multiplies and adds
+	namespace reference
+	{
+		void add(const float *a, const float *b, float *result)
+		{
+			for (unsigned int i = 0; i < 4 * 4; i++)
+				result[i] = a[i] + b[i];
+		}
+
+		void subtract(const float *a, const float *b, float *result)
+		{
+			for (unsigned int i = 0; i < 4 * 4; i++)
+				result[i] = a[i] - b[i];
+		}
+
+		void multiply(const float *a, float scalar, float *result)
+		{
+			for (unsigned int i = 0; i < 4 * 4; i++)
+				result[i] = a[i] * scalar;
+		}
+
+		void multiply(const float *a, const float *b, float *result)
+		{
+			for (unsigned int row = 0; row < 4; row++)
+			{
+				for (unsigned int column = 0; column < 4; column++)
+				{
+					float sum = 0.0f;
+					for (unsigned int i = 0; i < 4; i++)
+						sum += a[i + row * 4] * b[column + i * 4];
+					result[column + row * 4] = sum;
+				}
+			}
+		}
+
+		void transpose(const float *a, float *result)
+		{
+			for (unsigned int row = 0; row < 4; row++)
+			{
+				for (unsigned int column = 0; column < 4; column++)
+					result[row + column * 4] = a[column + row * 4];
+			}
+		}
+
+		Vec3 transformPoint(const float *e, const Vec3 &vec)
+		{
+			return Vec3(
+				e[0 + 0 * 4] * vec.x + e[1 + 0 * 4] * vec.y + e[2 + 0 * 4] * vec.z + e[3 + 0 * 4],
+				e[0 + 1 * 4] * vec.x + e[1 + 1 * 4] * vec.y + e[2 + 1 * 4] * vec.z + e[3 + 1 * 4],
+				e[0 + 2 * 4] * vec.x + e[1 + 2 * 4] * vec.y + e[2 + 2 * 4] * vec.z + e[3 + 2 * 4]
+			);
+		}
+
+		Vec3 transformDirection(const float *e, const Vec3 &vec)
+		{
+			return Vec3(
+				e[0 + 0 * 4] * vec.x + e[1 + 0 * 4] * vec.y + e[2 + 0 * 4] * vec.z,
+				e[0 + 1 * 4] * vec.x + e[1 + 1 * 4] * vec.y + e[2 + 1 * 4] * vec.z,
+				e[0 + 2 * 4] * vec.x + e[1 + 2 * 4] * vec.y + e[2 + 2 * 4] * vec.z
+			);
+		}
+	}
+
+	struct Check
+	{
+		std::string name;
+		long mismatches;
+	};
+
+	bool sameBits(const float *a, const float *b, size_t count)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			if (std::isnan(a[i]) && std::isnan(b[i]))
+				continue;
+			if (std::memcmp(&a[i], &b[i], sizeof(float)) != 0)
+				return false;
+		}
+		return true;
+	}
+
+	bool sameBits(const Vec3 *a, const Vec3 *b, size_t count)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			const float x[3] = {a[i].x, a[i].y, a[i].z};
+			const float y[3] = {b[i].x, b[i].y, b[i].z};
+			if (!sameBits(x, y, 3))
+				return false;
+		}
+		return true;
+	}
+
+	std::string simdLevel()
+	{
+#if defined(__AVX2__)
+		return "AVX2";
+#elif defined(__AVX__)
+		return "AVX";
+#elif defined(__SSE__)
+		return "SSE";
+#else
+		return "scalar";
+#endif
+	}
+}
+
+int main()
+{
+	std::mt19937 random(7);
+	std::uniform_real_distribution<float> value(-1000.0f, 1000.0f);
+	std::uniform_int_distribution<int> kind(0, 9);
+
+	// Mostly ordinary values, with the special ones the kernels could round
+	// or propagate differently
+	auto randomFloat = [&]()
+	{
+		switch (kind(random))
+		{
+			case 0:
+				return 0.0f;
+			case 1:
+				return -0.0f;
+			case 2:
+				return value(random) * 1e-40f;
+			case 3:
+				return INFINITY;
+			default:
+				return value(random);
+		}
+	};
+
+	std::vector<Check> checks = {
+		{"Mat4 + Mat4", 0},
+		{"Mat4 - Mat4", 0},
+		{"Mat4 * float", 0},
+		{"Mat4 * Mat4", 0},
+		{"Mat4::transpose", 0},
+		{"Mat4::transformPoint", 0},
+		{"Mat4::transformDirection", 0},
+		{"Mat4::transformPoints", 0},
+		{"Mat4::transformDirections", 0},
+		{"Vec3Array::transformPoints", 0},
+		{"Vec3Array::transformDirections", 0},
+		{"Vec3Array::normalize", 0},
+		{"Vec3Array::dot(Vec3)", 0},
+		{"Vec3Array::dot(Vec3Array)", 0},
+		{"Vec3Array::cross", 0},
+		{"Vec3Array::bounds", 0},
+	};
+
+	float a[4 * 4], b[4 * 4], expected[4 * 4];
+	Vec3 vecs[batchSize], others[batchSize], results[batchSize], expectedVecs[batchSize];
+	float dots[batchSize], expectedDots[batchSize];
+
+	for (int i = 0; i < caseCount; i++)
+	{
+		for (unsigned int j = 0; j < 4 * 4; j++)
+		{
+			a[j] = randomFloat();
+			b[j] = randomFloat();
+		}
+		for (Vec3 &vec : vecs)
+			vec = Vec3(randomFloat(), randomFloat(), randomFloat());
+		for (Vec3 &vec : others)
+			vec = Vec3(randomFloat(), randomFloat(), randomFloat());
+		const float scalar = randomFloat();
+		const Mat4 matA(a), matB(b);
+
+		reference::add(a, b, expected);
+		checks[0].mismatches += !sameBits((matA + matB).getElements(), expected, 4 * 4);
+
+		reference::subtract(a, b, expected);
+		checks[1].mismatches += !sameBits((matA - matB).getElements(), expected, 4 * 4);
+
+		reference::multiply(a, scalar, expected);
+		checks[2].mismatches += !sameBits((matA * scalar).getElements(), expected, 4 * 4);
+
+		reference::multiply(a, b, expected);
+		checks[3].mismatches += !sameBits((matA * matB).getElements(), expected, 4 * 4);
+
+		reference::transpose(a, expected);
+		checks[4].mismatches += !sameBits(matA.transpose().getElements(), expected, 4 * 4);
+
+		const Vec3 point = matA.transformPoint(vecs[0]), expectedPoint = reference::transformPoint(a, vecs[0]);
+		checks[5].mismatches += !sameBits(&point, &expectedPoint, 1);
+
+		const Vec3 direction = matA.transformDirection(vecs[0]), expectedDirection = reference::transformDirection(a, vecs[0]);
+		checks[6].mismatches += !sameBits(&direction, &expectedDirection, 1);
+
+		matA.transformPoints(vecs, results, batchSize);
+		for (size_t j = 0; j < batchSize; j++)
+			expectedVecs[j] = reference::transformPoint(a, vecs[j]);
+		checks[7].mismatches += !sameBits(results, expectedVecs, batchSize);
+
+		matA.transformDirections(vecs, results, batchSize);
+		for (size_t j = 0; j < batchSize; j++)
+			expectedVecs[j] = reference::transformDirection(a, vecs[j]);
+		checks[8].mismatches += !sameBits(results, expectedVecs, batchSize);
+
+		const Vec3Array array(vecs, batchSize), otherArray(others, batchSize);
+		Vec3Array transformed = array;
+
+		transformed.transformPoints(matA);
+		for (size_t j = 0; j < batchSize; j++)
+		{
+			results[j] = transformed[j];
+			expectedVecs[j] = reference::transformPoint(a, vecs[j]);
+		}
+		checks[9].mismatches += !sameBits(results, expectedVecs, batchSize);
+
+		transformed = array;
+		transformed.transformDirections(matA);
+		for (size_t j = 0; j < batchSize; j++)
+		{
+			results[j] = transformed[j];
+			expectedVecs[j] = reference::transformDirection(a, vecs[j]);
+		}
+		checks[10].mismatches += !sameBits(results, expectedVecs, batchSize);
+
+		transformed = array;
+		transformed.normalize();
+		for (size_t j = 0; j < batchSize; j++)
+		{
+			results[j] = transformed[j];
+			expectedVecs[j] = vecs[j].normalize();
+		}
+		checks[11].mismatches += !sameBits(results, expectedVecs, batchSize);
+
+		array.dot(others[0], dots);
+		for (size_t j = 0; j < batchSize; j++)
+			expectedDots[j] = vecs[j].dot(others[0]);
+		checks[12].mismatches += !sameBits(dots, expectedDots, batchSize);
+
+		array.dot(otherArray, dots);
+		for (size_t j = 0; j < batchSize; j++)
+			expectedDots[j] = vecs[j].dot(others[j]);
+		checks[13].mismatches += !sameBits(dots, expectedDots, batchSize);
+
+		const Vec3Array crosses = array.cross(otherArray);
+		for (size_t j = 0; j < batchSize; j++)
+		{
+			results[j] = crosses[j];
+			expectedVecs[j] = vecs[j].cross(others[j]);
+		}
+		checks[14].mismatches += !sameBits(results, expectedVecs, batchSize);
+
+		// A reduction whose lanes are merged out of order, so a zero bound may
+		// come out with either sign: compared by value rather than by bits
+		Vec3 min(INFINITY), max(-INFINITY), expectedMin(INFINITY), expectedMax(-INFINITY);
+		array.bounds(min, max);
+		for (const Vec3 &vec : vecs)
+		{
+			expectedMin = Vec3(std::min(expectedMin.x, vec.x), std::min(expectedMin.y, vec.y), std::min(expectedMin.z, vec.z));
+			expectedMax = Vec3(std::max(expectedMax.x, vec.x), std::max(expectedMax.y, vec.y), std::max(expectedMax.z, vec.z));
+		}
+		checks[15].mismatches += !(min == expectedMin && max == expectedMax);
+	}
+
+	std::cout << "scop math test, " << __VERSION__ << ", " << simdLevel() << ", "
+			  << caseCount << " cases" << std::endl << std::endl;
+
+	long failures = 0;
+	for (const Check &check : checks)
+	{
+		std::cout << std::left << std::setw(32) << check.name
+				  << (check.mismatches ? "FAIL " + std::to_string(check.mismatches) + " mismatches" : "ok") << std::endl;
+		failures += check.mismatches;
+	}
+
+	return failures ? 1 : 0;
+}
\ No newline at end of file